@@ -0,0 +1,383 @@
+/*
+ * Copyright (c) 2012-2015 Simon Schoenenberger
+ * http://blipkit.audio
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/**
+ * Measures render speed of units, samples, context readout and tracks
+ *
+ * Each benchmark prints one tab separated line:
+ *   name, channels, sample rate, frames, seconds, frames/second, ns/frame
+ *
+ * Usage: blipkit_bench [seconds]
+ *   seconds: length of generated audio per benchmark (default 10)
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "BlipKit.h"
+
+#define BENCH_CHUNK_SIZE 512
+#define BENCH_NUM_UNITS 8
+#define BENCH_TABLE_LENGTH 1024
+#define BENCH_SAMPLE_LENGTH 44100
+
+static BKFrame benchFrames[BENCH_CHUNK_SIZE * BK_MAX_CHANNELS];
+static BKFrame benchTable[BENCH_TABLE_LENGTH];
+static BKFrame benchSample[BENCH_SAMPLE_LENGTH];
+static double benchSeconds = 10.0;
+
+/**
+ * Get wall clock time in seconds
+ */
+static double benchTime(void) {
+	struct timespec time;
+
+	timespec_get(&time, TIME_UTC);
+
+	return (double)time.tv_sec + (double)time.tv_nsec * 1e-9;
+}
+
+static void benchPrintHeader(void) {
+	printf("# name\tchannels\tsample_rate\tframes\tseconds\tframes_per_sec\tns_per_frame\n");
+}
+
+static void benchPrintResult(char const* name, BKUInt numChannels, BKUInt sampleRate, BKUInt numFrames, double seconds) {
+	double framesPerSec = seconds > 0.0 ? numFrames / seconds : 0.0;
+	double nsPerFrame = numFrames > 0 ? seconds * 1e9 / numFrames : 0.0;
+
+	printf("%s\t%u\t%u\t%u\t%.6f\t%.0f\t%.3f\n", name, numChannels, sampleRate, numFrames, seconds, framesPerSec, nsPerFrame);
+	fflush(stdout);
+}
+
+static BKUInt benchNumFrames(BKUInt sampleRate) {
+	return (BKUInt)(benchSeconds * sampleRate);
+}
+
+/**
+ * Generate `numFrames` frames and return elapsed time
+ */
+static double benchGenerate(BKContext* ctx, BKUInt numFrames) {
+	double start = benchTime();
+
+	for (BKUInt i = 0; i < numFrames; i += BENCH_CHUNK_SIZE) {
+		BKContextGenerate(ctx, benchFrames, BKMin(numFrames - i, BENCH_CHUNK_SIZE));
+	}
+
+	return benchTime() - start;
+}
+
+/**
+ * Get unit phase period for `freq`
+ */
+static BKInt benchPeriod(BKContext* ctx, BKUnit* unit, double freq) {
+	BKInt numPhases = 1;
+
+	BKGetAttr(unit, BK_NUM_PHASES, &numPhases);
+
+	return (BKInt)(ctx->sampleRate * (double)BK_FINT20_UNIT / (freq * BKMax(numPhases, 1)));
+}
+
+static void benchInitData(void) {
+	for (BKInt i = 0; i < BENCH_TABLE_LENGTH; i++) {
+		benchTable[i] = (BKFrame)(sin(2.0 * M_PI * i / BENCH_TABLE_LENGTH) * 16000.0 + sin(6.0 * M_PI * i / BENCH_TABLE_LENGTH) * 8000.0);
+	}
+
+	srand(1);
+
+	for (BKInt i = 0; i < BENCH_SAMPLE_LENGTH; i++) {
+		benchSample[i] = (BKFrame)(sin(2.0 * M_PI * 261.63 * i / 44100.0) * 12000.0 + (rand() % 4001 - 2000));
+	}
+}
+
+/**
+ * Render `BENCH_NUM_UNITS` units with `waveform`
+ *
+ * `data` is set as custom waveform or wavetable if not NULL
+ */
+static void benchUnitWaveform(char const* name, BKEnum waveform, BKData* data) {
+	BKContext ctx;
+	BKUnit units[BENCH_NUM_UNITS];
+	BKUInt sampleRate = 44100;
+	BKUInt numFrames = benchNumFrames(sampleRate);
+
+	BKContextInit(&ctx, 2, sampleRate);
+
+	for (BKInt i = 0; i < BENCH_NUM_UNITS; i++) {
+		BKUnit* unit = &units[i];
+
+		BKUnitInit(unit, data ? BK_SQUARE : waveform);
+		BKUnitAttach(unit, &ctx);
+
+		if (data) {
+			BKSetPtr(unit, waveform, data, 0);
+		}
+
+		BKSetAttr(unit, BK_VOLUME, BK_MAX_VOLUME / BENCH_NUM_UNITS);
+		BKSetAttr(unit, BK_PERIOD, benchPeriod(&ctx, unit, 110.0 * (i + 1)));
+	}
+
+	benchPrintResult(name, 2, sampleRate, numFrames, benchGenerate(&ctx, numFrames));
+
+	for (BKInt i = 0; i < BENCH_NUM_UNITS; i++) {
+		BKDispose(&units[i]);
+	}
+
+	BKDispose(&ctx);
+}
+
+/**
+ * Play sample with `period` and `interpolation`
+ */
+static void benchSamplePlayback(char const* name, BKData* data, double period, BKEnum interpolation) {
+	BKContext ctx;
+	BKUnit unit;
+	BKUInt sampleRate = 44100;
+	BKUInt numFrames = benchNumFrames(sampleRate);
+
+	BKContextInit(&ctx, 2, sampleRate);
+	BKUnitInit(&unit, BK_SQUARE);
+	BKUnitAttach(&unit, &ctx);
+	BKSetAttr(&unit, BK_PERIOD, BK_FINT20_UNIT); // units only run with a period
+	BKSetPtr(&unit, BK_SAMPLE, data, 0);
+	BKSetAttr(&unit, BK_SAMPLE_REPEAT, BK_REPEAT);
+	BKSetAttr(&unit, BK_SAMPLE_PERIOD, (BKInt)(period * BK_FINT20_UNIT));
+	BKSetAttr(&unit, BK_SAMPLE_INTERPOLATION, interpolation);
+	BKSetAttr(&unit, BK_VOLUME, BK_MAX_VOLUME / 2);
+
+	benchPrintResult(name, 2, sampleRate, numFrames, benchGenerate(&ctx, numFrames));
+
+	BKDispose(&unit);
+	BKDispose(&ctx);
+}
+
+/**
+ * Measure only the readout of `numChannels` buffers at `sampleRate`
+ */
+static void benchRead(BKUInt numChannels, BKUInt sampleRate) {
+	BKContext ctx;
+	BKUnit unit;
+	BKUInt numFrames = benchNumFrames(sampleRate);
+	double seconds = 0.0;
+	char name[64];
+
+	BKContextInit(&ctx, numChannels, sampleRate);
+	BKUnitInit(&unit, BK_SAWTOOTH);
+	BKUnitAttach(&unit, &ctx);
+	BKSetAttr(&unit, BK_VOLUME, BK_MAX_VOLUME / 2);
+	BKSetAttr(&unit, BK_PERIOD, benchPeriod(&ctx, &unit, 440.0));
+
+	for (BKUInt i = 0; i < numFrames; i += BENCH_CHUNK_SIZE) {
+		BKUInt size = BKMin(numFrames - i, BENCH_CHUNK_SIZE);
+		double start;
+
+		BKContextEnd(&ctx, (BKFUInt64)size << BK_FINT20_SHIFT);
+
+		start = benchTime();
+		BKContextRead(&ctx, benchFrames, size);
+		seconds += benchTime() - start;
+	}
+
+	snprintf(name, sizeof(name), "read/%uch/%u", numChannels, sampleRate);
+	benchPrintResult(name, numChannels, sampleRate, numFrames, seconds);
+
+	BKDispose(&unit);
+	BKDispose(&ctx);
+}
+
+typedef struct {
+	BKTrack* tracks;
+	BKUInt numTracks;
+	BKUInt step;
+} BKBenchSong;
+
+/**
+ * Play a new note on every track
+ */
+static BKEnum benchSongCallback(BKCallbackInfo* info, void* userInfo) {
+	static BKInt const notes[8] = {
+		BK_C_3, BK_E_3, BK_G_3, BK_B_3, BK_C_4, BK_A_3, BK_F_3, BK_D_3,
+	};
+
+	BKBenchSong* song = userInfo;
+
+	for (BKUInt i = 0; i < song->numTracks; i++) {
+		BKTrack* track = &song->tracks[i];
+		BKInt note = notes[(song->step + i) & 7] + 12 * (i % 3);
+
+		BKSetAttr(track, BK_NOTE, note * BK_FINT20_UNIT);
+
+		if (((song->step + i) & 3) == 0) {
+			BKInt arpeggio[3] = { 2, 0, 7 * BK_FINT20_UNIT };
+			BKSetPtr(track, BK_ARPEGGIO, arpeggio, sizeof(arpeggio));
+		}
+	}
+
+	song->step++;
+
+	return 0;
+}
+
+/**
+ * Play `numTracks` tracks with instruments and effects while the master
+ * clock ticks with `clockRate`
+ */
+static void benchTracks(BKUInt numTracks, BKUInt clockRate) {
+	static BKEnum const waveforms[4] = { BK_SQUARE, BK_TRIANGLE, BK_SAWTOOTH, BK_NOISE };
+	static BKInt const volumes[8] = {
+		BK_MAX_VOLUME, BK_MAX_VOLUME * 7 / 8, BK_MAX_VOLUME * 3 / 4, BK_MAX_VOLUME * 5 / 8,
+		BK_MAX_VOLUME / 2, BK_MAX_VOLUME / 2, BK_MAX_VOLUME / 4, 0,
+	};
+	static BKInt const pitches[4] = { 0, BK_FINT20_UNIT / 4, 0, -BK_FINT20_UNIT / 4 };
+	static BKInt const dutyCycles[4] = { 2, 4, 6, 8 };
+
+	BKContext ctx;
+	BKInstrument instrument;
+	BKDivider divider;
+	BKBenchSong song;
+	BKUInt sampleRate = 44100;
+	BKUInt numFrames = benchNumFrames(sampleRate);
+	BKFUInt64 clockPeriod = ((BKFUInt64)sampleRate << BK_FINT20_SHIFT) / clockRate;
+	BKTime period = BKTimeMake((BKInt)(clockPeriod >> BK_FINT20_SHIFT), (BKFUInt20)(clockPeriod & BK_FINT20_FRAC));
+	char name[64];
+
+	BKContextInit(&ctx, 2, sampleRate);
+	BKSetPtr(&ctx, BK_CLOCK_PERIOD, &period, sizeof(period));
+
+	BKInstrumentInit(&instrument);
+	BKInstrumentSetSequence(&instrument, BK_SEQUENCE_VOLUME, volumes, 8, 4, 2);
+	BKInstrumentSetSequence(&instrument, BK_SEQUENCE_PITCH, pitches, 4, 0, 4);
+	BKInstrumentSetSequence(&instrument, BK_SEQUENCE_DUTY_CYCLE, dutyCycles, 4, 0, 4);
+
+	song.tracks = calloc(numTracks, sizeof(BKTrack));
+	song.numTracks = numTracks;
+	song.step = 0;
+
+	if (song.tracks == NULL) {
+		fprintf(stderr, "Allocation failed\n");
+		exit(1);
+	}
+
+	for (BKUInt i = 0; i < numTracks; i++) {
+		BKTrack* track = &song.tracks[i];
+		BKInt vibrato[2] = { 8 + (i & 7), BK_FINT20_UNIT / 2 };
+		BKInt tremolo[2] = { 12 + (i & 3), BK_MAX_VOLUME / 4 };
+		BKInt portamento[1] = { 6 };
+
+		BKTrackInit(track, waveforms[i & 3]);
+		BKSetAttr(track, BK_MASTER_VOLUME, BK_MAX_VOLUME / numTracks);
+		BKSetAttr(track, BK_VOLUME, BK_MAX_VOLUME);
+		BKTrackAttach(track, &ctx);
+		BKSetPtr(track, BK_INSTRUMENT, &instrument, sizeof(void*));
+		BKSetPtr(track, BK_EFFECT_VIBRATO, vibrato, sizeof(vibrato));
+		BKSetPtr(track, BK_EFFECT_TREMOLO, tremolo, sizeof(tremolo));
+		BKSetPtr(track, BK_EFFECT_PORTAMENTO, portamento, sizeof(portamento));
+	}
+
+	BKDividerInit(&divider, BKMax(clockRate / 16, 1), &(BKCallback){
+		.func = benchSongCallback,
+		.userInfo = &song,
+	});
+	BKContextAttachDivider(&ctx, &divider, BK_CLOCK_TYPE_BEAT);
+
+	snprintf(name, sizeof(name), "tracks/%u/%uhz", numTracks, clockRate);
+	benchPrintResult(name, 2, sampleRate, numFrames, benchGenerate(&ctx, numFrames));
+
+	for (BKUInt i = 0; i < numTracks; i++) {
+		BKDispose(&song.tracks[i]);
+	}
+
+	free(song.tracks);
+	BKDispose(&divider);
+	BKDispose(&instrument);
+	BKDispose(&ctx);
+}
+
+int main(int argc, char const* argv[]) {
+	static BKUInt const sampleRates[3] = { 22050, 44100, BK_MAX_SAMPLE_RATE };
+	static double const periods[4] = { 0.5, 1.0, 1.5, 2.0 };
+	static struct {
+		char const* name;
+		BKEnum interpolation;
+	} const interpolations[4] = {
+		{ "none", BK_INTERPOLATION_NONE },
+		{ "linear", BK_INTERPOLATION_LINEAR },
+		{ "cubic", BK_INTERPOLATION_CUBIC },
+		{ "sinc", BK_INTERPOLATION_SINC },
+	};
+
+	BKData custom, table, sample;
+	char name[64];
+
+	if (argc > 1) {
+		benchSeconds = atof(argv[1]);
+
+		if (benchSeconds <= 0.0) {
+			fprintf(stderr, "Usage: %s [seconds]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	benchInitData();
+
+	BKDataInit(&custom);
+	BKDataInit(&table);
+	BKDataInit(&sample);
+	BKDataSetFrames(&custom, benchTable, 32, 1, 1);
+	BKDataSetFrames(&table, benchTable, BENCH_TABLE_LENGTH, 1, 1);
+	BKDataSetFrames(&sample, benchSample, BENCH_SAMPLE_LENGTH, 1, 1);
+
+	benchPrintHeader();
+
+	benchUnitWaveform("unit/square", BK_SQUARE, NULL);
+	benchUnitWaveform("unit/triangle", BK_TRIANGLE, NULL);
+	benchUnitWaveform("unit/noise", BK_NOISE, NULL);
+	benchUnitWaveform("unit/sawtooth", BK_SAWTOOTH, NULL);
+	benchUnitWaveform("unit/sine", BK_SINE, NULL);
+	benchUnitWaveform("unit/custom", BK_WAVEFORM, &custom);
+	benchUnitWaveform("unit/wavetable", BK_WAVETABLE, &table);
+
+	for (BKInt i = 0; i < 4; i++) {
+		for (BKInt j = 0; j < 4; j++) {
+			snprintf(name, sizeof(name), "sample/%s/%.2f", interpolations[j].name, periods[i]);
+			benchSamplePlayback(name, &sample, periods[i], interpolations[j].interpolation);
+		}
+	}
+
+	for (BKUInt c = 1; c <= BK_MAX_CHANNELS; c++) {
+		for (BKInt i = 0; i < 3; i++) {
+			benchRead(c, sampleRates[i]);
+		}
+	}
+
+	benchTracks(8, 240);
+	benchTracks(32, 240);
+	benchTracks(32, 1000);
+
+	BKDispose(&sample);
+	BKDispose(&table);
+	BKDispose(&custom);
+
+	return 0;
+}
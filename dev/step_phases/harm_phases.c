@@ -21,77 +21,47 @@
  * IN THE SOFTWARE.
  */
 
-#include "BKBase.h"
 #include "BKBuffer.h"
-#include <math.h>
 #include <stdio.h>
 
-static BKInt stepPhases[BK_STEP_UNIT][BK_STEP_WIDTH];
-
 int main(int argc, char const* argv[]) {
-	int const size = BK_STEP_WIDTH;
+	BKBufferPulse pulse;
+	BKUInt width = BK_STEP_WIDTH;
+	double cutoff = 1.0;
+
+	if (argc > 1) {
+		width = atoi(argv[1]);
+	}
+
+	if (argc > 2) {
+		cutoff = atof(argv[2]);
+	}
+
+	if (BKBufferPulseInit(&pulse, BK_PULSE_KERNEL_HARM, width, cutoff) < 0) {
+		fprintf(stderr, "Usage: %s [width: 8, 16, 32] [cutoff: (0, 1]]\n", argv[0]);
+		return 1;
+	}
 
 	printf(
 		"/**\n"
 		" * Bandlimited step phases\n"
 		" * Generated with `%s`\n"
 		" */\n"
-		"BKInt const BKBufferStepPhases [BK_STEP_UNIT][BK_STEP_WIDTH] =\n{\n",
-		__FILE__);
+		"BKBufferPulse const BKBufferStepPhases = { .width = %u, .delay = %u, .frames = {\n",
+		__FILE__, pulse.width, pulse.delay);
 
 	// step phase
 	for (int phase = 0; phase < BK_STEP_UNIT; phase++) {
-		double wave[BK_STEP_UNIT + 1];
-		double shift = -((double)phase / BK_STEP_UNIT);
-
-		memset(wave, 0, sizeof(wave));
-
 		printf("\t{");
 
-		// phase offset
-		for (double n = 1; n <= 31; n += 2) {
-			for (double x = -size / 2; x <= size / 2; x++) {
-				double a = (x + shift) * M_PI / 31;
-
-				wave[(int)x + size / 2] += sin(n * a) / n;
-			}
-		}
-
-		double sum = 0;
-		double sumf = 0;
-		double last = wave[0];
-		BKInt value = 0;
-
-		for (int i = 0; i <= size; i++) {
-			double diff = wave[i] - last;
-			last = wave[i];
-			wave[i] = diff;
-			sumf += diff;
-		}
-
-		for (int i = 1; i <= size; i++) {
-			wave[i] /= sumf;
-
-			// apply Blackman window
-			double w = i - 0.5;
-			wave[i] *= 0.42 - 0.5 * cos(2 * M_PI * w / size) + 0.08 * cos(4 * M_PI * w / size);
-
-			value = wave[i] * BK_FRAME_MAX;
-			stepPhases[phase][i - 1] = value;
-			sum += value;
-		}
-
-		// correct round-off error
-		stepPhases[phase][size / 2] += (BK_FRAME_MAX - sum);
-
-		for (BKInt i = 0; i < size; i++) {
-			printf("%6d, ", stepPhases[phase][i]);
+		for (BKInt i = 0; i < BK_STEP_WIDTH; i++) {
+			printf("%6d, ", pulse.frames[phase][i]);
 		}
 
 		printf("},\n");
 	}
 
-	printf("};\n\n");
+	printf("}};\n\n");
 
 	return 0;
 }
@@ -22,74 +22,46 @@
  */
 
 #include "BKBuffer.h"
-#include <math.h>
 #include <stdio.h>
 
-static BKInt stepPhases[BK_STEP_UNIT][BK_STEP_WIDTH];
-
 int main(int argc, char const* argv[]) {
-	int const size = BK_STEP_WIDTH;
-	double phasef[size];
+	BKBufferPulse pulse;
+	BKUInt width = BK_STEP_WIDTH;
+	double cutoff = 1.0;
+
+	if (argc > 1) {
+		width = atoi(argv[1]);
+	}
+
+	if (argc > 2) {
+		cutoff = atof(argv[2]);
+	}
+
+	if (BKBufferPulseInit(&pulse, BK_PULSE_KERNEL_SINC, width, cutoff) < 0) {
+		fprintf(stderr, "Usage: %s [width: 8, 16, 32] [cutoff: (0, 1]]\n", argv[0]);
+		return 1;
+	}
 
 	printf(
 		"/**\n"
 		" * Bandlimited step phases\n"
 		" * Generated with `%s`\n"
 		" */\n"
-		"BKInt const BKBufferStepPhases [BK_STEP_UNIT][BK_STEP_WIDTH] =\n{\n",
-		__FILE__);
+		"BKBufferPulse const BKBufferStepPhases = { .width = %u, .delay = %u, .frames = {\n",
+		__FILE__, pulse.width, pulse.delay);
 
 	// step phase
 	for (int phase = 0; phase < BK_STEP_UNIT; phase++) {
-		double sumf = 0.0;
-		BKInt value = 0;
-		BKInt sum = 0;
-
 		printf("\t{");
 
-		// phase offset
-		for (BKInt i = 0; i < size; i++) {
-			double delta = 0.0;
-			double iphase = i - (size / 2) - ((double)phase / BK_STEP_UNIT) + (1.0 / BK_STEP_UNIT / 2);
-
-			// iphase += (0.3 / 16.0);
-
-			// printf("%lf ", iphase);
-
-			// prevent division by zero
-			if (iphase != 0.0) {
-				// sinc
-				delta = sin(iphase * M_PI) / (iphase * M_PI);
-				// apply Blackman window
-				double w = i + 0.5;
-				delta *= 0.42 - 0.5 * cos(2 * M_PI * w / size) + 0.08 * cos(4 * M_PI * w / size);
-			}
-			else {
-				delta = 1.0;
-			}
-
-			phasef[i] = delta;
-			sumf += delta;
-		}
-
-		// normalize step
-		for (BKInt i = 0; i < size; i++) {
-			value = phasef[i] / sumf * BK_FRAME_MAX;
-			stepPhases[phase][i] = value;
-			sum += value;
-		}
-
-		// correct round-off error
-		stepPhases[phase][size / 2] += (BK_FRAME_MAX - sum);
-
-		for (BKInt i = 0; i < size; i++) {
-			printf("%6d, ", stepPhases[phase][i]);
+		for (BKInt i = 0; i < BK_STEP_WIDTH; i++) {
+			printf("%6d, ", pulse.frames[phase][i]);
 		}
 
 		printf("},\n");
 	}
 
-	printf("};\n\n");
+	printf("}};\n\n");
 
 	return 0;
 }
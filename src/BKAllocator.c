@@ -0,0 +1,189 @@
+/*
+ * Copyright (c) 2012-2015 Simon Schoenenberger
+ * http://blipkit.audio
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "BKAllocator.h"
+
+#define BK_ARENA_HEADER_SIZE BK_ARENA_ALIGN // stores allocation size and keeps alignment
+
+static void* BKSystemAlloc(BKUSize size, void* info) {
+	return malloc(size);
+}
+
+static void* BKSystemRealloc(void* ptr, BKUSize size, void* info) {
+	return realloc(ptr, size);
+}
+
+static void BKSystemFree(void* ptr, void* info) {
+	free(ptr);
+}
+
+static BKAllocator const BKSystemAllocator = {
+	.alloc = BKSystemAlloc,
+	.realloc = BKSystemRealloc,
+	.free = BKSystemFree,
+};
+
+static BKAllocator BKCurrentAllocator = {
+	.alloc = BKSystemAlloc,
+	.realloc = BKSystemRealloc,
+	.free = BKSystemFree,
+};
+
+BKInt BKSetAllocator(BKAllocator const* allocator) {
+	if (allocator == NULL) {
+		allocator = &BKSystemAllocator;
+	}
+
+	if (!allocator->alloc || !allocator->realloc || !allocator->free) {
+		return BK_INVALID_VALUE;
+	}
+
+	BKCurrentAllocator = *allocator;
+
+	return 0;
+}
+
+void BKGetAllocator(BKAllocator* outAllocator) {
+	*outAllocator = BKCurrentAllocator;
+}
+
+void* BKMemAlloc(BKUSize size) {
+	return BKCurrentAllocator.alloc(size, BKCurrentAllocator.info);
+}
+
+void* BKMemCalloc(BKUSize count, BKUSize size) {
+	// overflow
+	if (size && count > (BKUSize)-1 / size) {
+		return NULL;
+	}
+
+	void* ptr = BKMemAlloc(count * size);
+
+	if (ptr) {
+		memset(ptr, 0, count * size);
+	}
+
+	return ptr;
+}
+
+void* BKMemRealloc(void* ptr, BKUSize size) {
+	if (ptr == NULL) {
+		return BKMemAlloc(size);
+	}
+
+	return BKCurrentAllocator.realloc(ptr, size, BKCurrentAllocator.info);
+}
+
+void BKMemFree(void* ptr) {
+	if (ptr) {
+		BKCurrentAllocator.free(ptr, BKCurrentAllocator.info);
+	}
+}
+
+BKInt BKArenaInit(BKArena* arena, void* data, BKUSize size) {
+	memset(arena, 0, sizeof(*arena));
+
+	if (data == NULL) {
+		data = malloc(size);
+
+		if (data == NULL) {
+			return BK_ALLOCATION_ERROR;
+		}
+
+		arena->freeData = 1;
+	}
+
+	arena->data = data;
+	arena->size = size;
+
+	return 0;
+}
+
+void BKArenaDispose(BKArena* arena) {
+	if (arena->freeData) {
+		free(arena->data);
+	}
+
+	memset(arena, 0, sizeof(*arena));
+}
+
+void BKArenaReset(BKArena* arena) {
+	arena->offset = 0;
+	arena->last = 0;
+}
+
+static void* BKArenaAlloc(BKUSize size, BKArena* arena) {
+	BKUSize start = (BKUSize)arena->data + arena->offset + BK_ARENA_HEADER_SIZE;
+	BKUSize offset = ((start + BK_ARENA_ALIGN - 1) & ~(BKUSize)(BK_ARENA_ALIGN - 1)) - (BKUSize)arena->data;
+
+	if (offset > arena->size || size > arena->size - offset) {
+		return NULL;
+	}
+
+	char* ptr = &arena->data[offset];
+	((BKUSize*)ptr)[-1] = size;
+
+	arena->last = offset;
+	arena->offset = offset + size;
+
+	return ptr;
+}
+
+static void* BKArenaRealloc(void* ptr, BKUSize size, BKArena* arena) {
+	BKUSize oldSize = ((BKUSize*)ptr)[-1];
+
+	// grow or shrink last allocation in place
+	if ((char*)ptr == &arena->data[arena->last]) {
+		if (size > arena->size - arena->last) {
+			return NULL;
+		}
+
+		((BKUSize*)ptr)[-1] = size;
+		arena->offset = arena->last + size;
+
+		return ptr;
+	}
+
+	void* newPtr = BKArenaAlloc(size, arena);
+
+	if (newPtr) {
+		memcpy(newPtr, ptr, BKMin(size, oldSize));
+	}
+
+	return newPtr;
+}
+
+static void BKArenaFree(void* ptr, BKArena* arena) {
+	// only last allocation is released
+	if (arena->last && (char*)ptr == &arena->data[arena->last]) {
+		arena->offset = arena->last - BK_ARENA_HEADER_SIZE;
+		arena->last = 0;
+	}
+}
+
+void BKArenaGetAllocator(BKArena* arena, BKAllocator* outAllocator) {
+	outAllocator->alloc = (BKAllocFunc)BKArenaAlloc;
+	outAllocator->realloc = (BKReallocFunc)BKArenaRealloc;
+	outAllocator->free = (BKFreeFunc)BKArenaFree;
+	outAllocator->info = arena;
+}
@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2012-2015 Simon Schoenenberger
+ * http://blipkit.audio
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef _BK_ALLOCATOR_H_
+#define _BK_ALLOCATOR_H_
+
+#include "BKBase.h"
+
+#define BK_ARENA_ALIGN 16 // alignment of arena allocations
+
+typedef struct BKAllocator BKAllocator;
+typedef struct BKArena BKArena;
+
+typedef void* (*BKAllocFunc)(BKUSize size, void* info);
+typedef void* (*BKReallocFunc)(void* ptr, BKUSize size, void* info);
+typedef void (*BKFreeFunc)(void* ptr, void* info);
+
+/**
+ * Memory functions used for all allocations of objects, buffers and data
+ * `realloc` and `free` are never called with NULL
+ */
+struct BKAllocator {
+	BKAllocFunc alloc;
+	BKReallocFunc realloc;
+	BKFreeFunc free;
+	void* info;
+};
+
+/**
+ * Bump allocator serving allocations from a single block
+ * Memory is released all at once with `BKArenaReset`
+ * Only the last allocation can be freed or grown in place
+ * Not thread-safe
+ */
+struct BKArena {
+	char* data;
+	BKUSize size;
+	BKUSize offset; // end of last allocation
+	BKUSize last;	// start of last allocation or 0
+	BKInt freeData; // block was allocated by arena
+};
+
+/**
+ * Set allocator used for all further allocations
+ * Passing NULL restores the system allocator
+ * Memory is freed with the allocator set at that time,
+ * so the allocator should only be changed when no objects exist
+ *
+ * Errors:
+ * BK_INVALID_VALUE if a function is missing
+ */
+extern BKInt BKSetAllocator(BKAllocator const* allocator);
+
+/**
+ * Get current allocator
+ */
+extern void BKGetAllocator(BKAllocator* outAllocator);
+
+/**
+ * Allocate memory with current allocator
+ */
+extern void* BKMemAlloc(BKUSize size);
+
+/**
+ * Allocate zeroed memory for `count` elements of `size` bytes
+ */
+extern void* BKMemCalloc(BKUSize count, BKUSize size);
+
+/**
+ * Resize memory; allocates new memory if `ptr` is NULL
+ */
+extern void* BKMemRealloc(void* ptr, BKUSize size);
+
+/**
+ * Free memory; does nothing if `ptr` is NULL
+ */
+extern void BKMemFree(void* ptr);
+
+/**
+ * Initialize arena with block `data` of `size` bytes
+ * If `data` is NULL a block is allocated with the system allocator
+ *
+ * Errors:
+ * BK_ALLOCATION_ERROR if block could not be allocated
+ */
+extern BKInt BKArenaInit(BKArena* arena, void* data, BKUSize size);
+
+/**
+ * Free block if allocated by arena
+ */
+extern void BKArenaDispose(BKArena* arena);
+
+/**
+ * Release all allocations
+ */
+extern void BKArenaReset(BKArena* arena);
+
+/**
+ * Get allocator allocating from `arena`
+ */
+extern void BKArenaGetAllocator(BKArena* arena, BKAllocator* outAllocator);
+
+#endif /* ! _BK_ALLOCATOR_H_ */
@@ -22,6 +22,9 @@
  */
 
 #include "BKBase.h"
+#if BK_USE_PROFILING
+#include <time.h>
+#endif
 
 #define BK_STATUS_IDX(status) ((status) - BK_RETURN_TYPE)
 
@@ -52,3 +55,15 @@ char const* BKStatusGetName(BKEnum status) {
 
 	return name;
 }
+
+#if BK_USE_PROFILING
+
+uint64_t BKProfileTime(void) {
+	struct timespec time;
+
+	timespec_get(&time, TIME_UTC);
+
+	return (uint64_t)time.tv_sec * 1000000000 + time.tv_nsec;
+}
+
+#endif /* BK_USE_PROFILING */
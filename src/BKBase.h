@@ -79,6 +79,7 @@ typedef uintptr_t BKUSize;
 
 typedef int32_t BKFInt20;	// 12.20 fixed point signed
 typedef uint32_t BKFUInt20; // 12.20 fixed point
+typedef uint64_t BKFUInt64; // 44.20 fixed point
 
 /**
  * Limits.
@@ -103,8 +104,10 @@ typedef uint32_t BKFUInt20; // 12.20 fixed point
 #define BK_MAX_SAMPLE_PERIOD (1 << (BK_FINT20_SHIFT + 8))
 
 #define BK_MAX_GENERATE_SAMPLES ((1 << (BK_INT_SHIFT - BK_FINT20_SHIFT)) / 4)
+#define BK_MAX_RUN_PERIOD ((BKFUInt64)BK_INT_MAX / 3) // maximum time units run ahead of the end time
 
 #define BK_WAVE_MAX_LENGTH 64
+#define BK_WAVETABLE_MAX_LENGTH 4096
 
 /**
  * Wave phases.
@@ -229,6 +232,9 @@ enum {
 	BK_SAMPLE_RATE,
 	BK_TIME,
 	BK_PULSE_KERNEL,
+	BK_CONTEXT_BUFFER_CAPACITY,
+	BK_NUM_THREADS,
+	BK_PROFILE, // render counters; only available with `BK_USE_PROFILING`
 };
 
 /**
@@ -271,6 +277,7 @@ enum {
 	BK_EFFECT_DIVIDER,
 	BK_INSTRUMENT_DIVIDER,
 	BK_TRIANGLE_IGNORES_VOLUME,
+	BK_SAMPLE_INTERPOLATION, // interpolation mode BK_INTERPOLATION_NONE, BK_INTERPOLATION_LINEAR, ...
 };
 
 /**
@@ -293,6 +300,7 @@ enum {
 	BK_SINE,
 	BK_CUSTOM,
 	BK_SAMPLE,
+	BK_WAVETABLE,
 };
 
 /**
@@ -316,6 +324,7 @@ enum {
 	BK_EVENT_DIVIDER,
 	BK_EVENT_SAMPLE_BEGIN,
 	BK_EVENT_SAMPLE_RESET,
+	BK_EVENT_SCHEDULED,
 };
 
 /**
@@ -327,6 +336,16 @@ enum {
 	BK_PALINDROME,
 };
 
+/**
+ * Sample interpolation modes
+ */
+enum {
+	BK_INTERPOLATION_NONE,	 // nearest lower frame
+	BK_INTERPOLATION_LINEAR, // 2 frames
+	BK_INTERPOLATION_CUBIC,	 // 4 frames, Catmull-Rom spline
+	BK_INTERPOLATION_SINC,	 // 8 frames, windowed sinc
+};
+
 /**
  * Pulse kernels
  */
@@ -370,6 +389,15 @@ enum {
  */
 extern char const* BKStatusGetName(BKEnum status);
 
+#if BK_USE_PROFILING
+
+/**
+ * Get time in nanoseconds for profiling counters
+ */
+extern uint64_t BKProfileTime(void);
+
+#endif /* BK_USE_PROFILING */
+
 #if __GNUC__
 #define BK_DEPRECATED_FUNC(msg) __attribute__((deprecated(msg)))
 #else
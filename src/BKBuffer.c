@@ -22,6 +22,30 @@
  */
 
 #include "BKBuffer.h"
+#include "BKAllocator.h"
+#include <math.h>
+
+// accumulator has 2 bits headroom above the frame range
+#define BK_BUFFER_FLOAT_SCALE (1.0f / (1U << (BK_INT_SHIFT - 2 - 1)))
+
+#if defined(__SSE2__) || defined(_M_X64)
+#define BK_USE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define BK_USE_AVX2 1
+#include <immintrin.h>
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define BK_USE_NEON 1
+#include <arm_neon.h>
+#endif
+
+// centered kernels have the same delay for every width
+#define BK_STEP_DELAY_SINC ((BK_STEP_WIDTH << BK_FINT20_SHIFT) / 2 - BK_FINT20_UNIT / BK_STEP_UNIT / 2)
+#define BK_STEP_DELAY_HARM (((BK_STEP_WIDTH - 1) << BK_FINT20_SHIFT) / 2)
 
 extern BKBufferPulse const BKBufferStepPhasesSinc;
 extern BKBufferPulse const BKBufferStepPhasesHarm;
@@ -32,7 +56,7 @@ extern BKBufferPulse const BKBufferStepPhasesHarm;
  * Bandlimited step phases
  * Generated with `sinc_phases.c`
  */
-BKBufferPulse const BKBufferStepPhasesSinc = { .frames = {
+BKBufferPulse const BKBufferStepPhasesSinc = { .width = BK_STEP_WIDTH, .delay = BK_STEP_DELAY_SINC, .frames = {
 	{     0,      0,      0,      1,     -3,      6,    -10,     16,    -25,     36,    -52,     74,   -105,    155,   -249,    519,  32746,   -488,    230,   -140,     92,    -62,     42,    -28,     18,    -11,      7,     -4,      2,      0,      0,      0, },
 	{     0,      0,      0,     -1,      3,     -6,     10,    -16,     25,    -36,     52,    -73,    105,   -154,    246,   -504,  32762,    503,   -234,    141,    -93,     63,    -42,     28,    -18,     11,     -7,      4,     -2,      0,      0,      0, },
 	{     0,      0,      2,     -5,     11,    -19,     31,    -49,     74,   -108,    155,   -219,    312,   -456,    724,  -1463,  32672,   1556,   -712,    428,   -280,    189,   -128,     86,    -56,     35,    -21,     12,     -6,      2,      0,      0, },
@@ -71,7 +95,7 @@ BKBufferPulse const BKBufferStepPhasesSinc = { .frames = {
  * Bandlimited step phases
  * Generated with `harm_phases.c`
  */
-BKBufferPulse const BKBufferStepPhasesHarm = { .frames = {
+BKBufferPulse const BKBufferStepPhasesHarm = { .width = BK_STEP_WIDTH, .delay = BK_STEP_DELAY_HARM, .frames = {
 	{     0,      0,     -3,     10,    -25,     52,    -97,    168,   -276,    433,   -660,    991,  -1498,   2369,  -4328,  19208,  19287,  -4328,   2369,  -1498,    991,   -660,    433,   -276,    168,    -97,     52,    -25,     10,     -3,      0,      0, },
 	{     0,      0,     -1,      7,    -19,     42,    -83,    148,   -249,    398,   -616,    939,  -1436,   2297,  -4242,  18108,  20352,  -4368,   2416,  -1545,   1034,   -697,    464,   -300,    187,   -110,     61,    -30,     13,     -4,      1,      0, },
 	{     0,      0,      0,      3,    -13,     32,    -68,    127,   -219,    359,   -567,    877,  -1361,   2204,  -4113,  16983,  21387,  -4360,   2439,  -1576,   1066,   -727,    490,   -322,    204,   -122,     69,    -36,     16,     -6,      1,      0, },
@@ -113,60 +137,585 @@ BKBufferPulse const* const BKBufferPulseKernels[] = {
 	[BK_PULSE_KERNEL_HARM] = &BKBufferStepPhasesHarm,
 };
 
+/**
+ * Generate windowed sinc step phases
+ */
+static void BKBufferPulseInitSinc(BKInt stepPhases[BK_STEP_UNIT][BK_STEP_WIDTH], BKInt size, double cutoff) {
+	double phasef[BK_STEP_WIDTH];
+
+	// step phase
+	for (BKInt phase = 0; phase < BK_STEP_UNIT; phase++) {
+		double sumf = 0.0;
+		BKInt value = 0;
+		BKInt sum = 0;
+
+		// phase offset
+		for (BKInt i = 0; i < size; i++) {
+			double delta = 0.0;
+			double iphase = i - (size / 2) - ((double)phase / BK_STEP_UNIT) + (1.0 / BK_STEP_UNIT / 2);
+
+			// prevent division by zero
+			if (iphase != 0.0) {
+				// sinc
+				delta = sin(iphase * cutoff * M_PI) / (iphase * cutoff * M_PI);
+				// apply Blackman window
+				double w = i + 0.5;
+				delta *= 0.42 - 0.5 * cos(2 * M_PI * w / size) + 0.08 * cos(4 * M_PI * w / size);
+			}
+			else {
+				delta = 1.0;
+			}
+
+			phasef[i] = delta;
+			sumf += delta;
+		}
+
+		// normalize step
+		for (BKInt i = 0; i < size; i++) {
+			value = phasef[i] / sumf * BK_FRAME_MAX;
+			stepPhases[phase][i] = value;
+			sum += value;
+		}
+
+		// correct round-off error
+		stepPhases[phase][size / 2] += (BK_FRAME_MAX - sum);
+	}
+}
+
+/**
+ * Generate step phases from odd harmonics
+ */
+static void BKBufferPulseInitHarm(BKInt stepPhases[BK_STEP_UNIT][BK_STEP_WIDTH], BKInt size, double cutoff) {
+	double numHarmonics = (size - 1) * cutoff;
+
+	// step phase
+	for (BKInt phase = 0; phase < BK_STEP_UNIT; phase++) {
+		double wave[BK_STEP_WIDTH + 1];
+		double shift = -((double)phase / BK_STEP_UNIT);
+
+		memset(wave, 0, sizeof(wave));
+
+		// phase offset
+		for (double n = 1; n <= numHarmonics; n += 2) {
+			for (BKInt x = -size / 2; x <= size / 2; x++) {
+				double a = (x + shift) * M_PI / (size - 1);
+
+				wave[x + size / 2] += sin(n * a) / n;
+			}
+		}
+
+		double sum = 0;
+		double sumf = 0;
+		double last = wave[0];
+		BKInt value = 0;
+
+		for (BKInt i = 0; i <= size; i++) {
+			double diff = wave[i] - last;
+			last = wave[i];
+			wave[i] = diff;
+			sumf += diff;
+		}
+
+		for (BKInt i = 1; i <= size; i++) {
+			wave[i] /= sumf;
+
+			// apply Blackman window
+			double w = i - 0.5;
+			wave[i] *= 0.42 - 0.5 * cos(2 * M_PI * w / size) + 0.08 * cos(4 * M_PI * w / size);
+
+			value = wave[i] * BK_FRAME_MAX;
+			stepPhases[phase][i - 1] = value;
+			sum += value;
+		}
+
+		// correct round-off error
+		stepPhases[phase][size / 2] += (BK_FRAME_MAX - sum);
+	}
+}
+
+/**
+ * Move overshoot exceeding the frame range to the larger neighbour tap
+ * Keeps the sum of all taps unchanged
+ */
+static void BKBufferPulseFitPhase(BKInt phase[], BKInt size) {
+	for (BKInt i = 0; i < size; i++) {
+		BKInt excess = phase[i] - BKClamp(phase[i], -(BKInt)BK_FRAME_MAX, (BKInt)BK_FRAME_MAX);
+
+		if (excess) {
+			BKInt next = i + 1;
+
+			if (i == size - 1 || (i > 0 && phase[i - 1] > phase[i + 1])) {
+				next = i - 1;
+			}
+
+			phase[i] -= excess;
+			phase[next] += excess;
+		}
+	}
+}
+
+BKInt BKBufferPulseInit(BKBufferPulse* pulse, BKEnum kernel, BKUInt width, double cutoff) {
+	BKInt stepPhases[BK_STEP_UNIT][BK_STEP_WIDTH];
+
+	if (width != 8 && width != 16 && width != 32) {
+		return BK_INVALID_VALUE;
+	}
+
+	if (!(cutoff > 0.0 && cutoff <= 1.0)) {
+		return BK_INVALID_VALUE;
+	}
+
+	memset(stepPhases, 0, sizeof(stepPhases));
+
+	switch (kernel) {
+		case BK_PULSE_KERNEL_SINC: {
+			BKBufferPulseInitSinc(stepPhases, width, cutoff);
+			break;
+		}
+		case BK_PULSE_KERNEL_HARM: {
+			BKBufferPulseInitHarm(stepPhases, width, cutoff);
+			break;
+		}
+		default: {
+			return BK_INVALID_VALUE;
+			break;
+		}
+	}
+
+	BKUInt start = (BK_STEP_WIDTH - width) >> 1;
+
+	memset(pulse, 0, sizeof(*pulse));
+	pulse->width = width;
+	pulse->delay = kernel == BK_PULSE_KERNEL_SINC ? BK_STEP_DELAY_SINC : BK_STEP_DELAY_HARM;
+
+	// center kernel
+	for (BKInt phase = 0; phase < BK_STEP_UNIT; phase++) {
+		BKBufferPulseFitPhase(stepPhases[phase], width);
+
+		for (BKUInt i = 0; i < width; i++) {
+			pulse->frames[phase][start + i] = stepPhases[phase][i];
+		}
+	}
+
+	return 0;
+}
+
+BKInt BKBufferPulseIsValid(BKBufferPulse const* pulse) {
+	BKUInt width = pulse->width;
+
+	return width >= 8 && width <= BK_STEP_WIDTH && (width & 7) == 0 && pulse->delay < ((BK_STEP_WIDTH - 1) << BK_FINT20_SHIFT);
+}
+
+static void BKBufferAddPulseScalar(BKInt frames[], BKFrame const phase[], BKFrame pulse, BKUInt width) {
+	for (BKUInt i = 0; i < width; i++) {
+		frames[i] += (BKInt)phase[i] * pulse;
+	}
+}
+
+#if BK_USE_SSE2
+
+static void BKBufferAddPulseSSE2(BKInt frames[], BKFrame const phase[], BKFrame pulse, BKUInt width) {
+	__m128i p = _mm_set1_epi16(pulse);
+
+	for (BKUInt i = 0; i < width; i += 8) {
+		__m128i ph = _mm_loadu_si128((__m128i const*)&phase[i]);
+		// 16 x 16 bit products are exact when combining low and high parts
+		__m128i lo = _mm_mullo_epi16(ph, p);
+		__m128i hi = _mm_mulhi_epi16(ph, p);
+		__m128i* out = (__m128i*)&frames[i];
+
+		_mm_storeu_si128(&out[0], _mm_add_epi32(_mm_loadu_si128(&out[0]), _mm_unpacklo_epi16(lo, hi)));
+		_mm_storeu_si128(&out[1], _mm_add_epi32(_mm_loadu_si128(&out[1]), _mm_unpackhi_epi16(lo, hi)));
+	}
+}
+
+#endif /* BK_USE_SSE2 */
+
+#if BK_USE_AVX2
+
+__attribute__((target("avx2"))) static void BKBufferAddPulseAVX2(BKInt frames[], BKFrame const phase[], BKFrame pulse, BKUInt width) {
+	__m256i p = _mm256_set1_epi32(pulse);
+
+	for (BKUInt i = 0; i < width; i += 8) {
+		__m256i ph = _mm256_cvtepi16_epi32(_mm_loadu_si128((__m128i const*)&phase[i]));
+		__m256i* out = (__m256i*)&frames[i];
+
+		_mm256_storeu_si256(out, _mm256_add_epi32(_mm256_loadu_si256(out), _mm256_mullo_epi32(ph, p)));
+	}
+}
+
+#endif /* BK_USE_AVX2 */
+
+#if BK_USE_NEON
+
+static void BKBufferAddPulseNEON(BKInt frames[], BKFrame const phase[], BKFrame pulse, BKUInt width) {
+	for (BKUInt i = 0; i < width; i += 4) {
+		vst1q_s32(&frames[i], vmlal_n_s16(vld1q_s32(&frames[i]), vld1_s16(&phase[i]), pulse));
+	}
+}
+
+#endif /* BK_USE_NEON */
+
+BKInt BKBufferGetAddPulseFuncs(BKBufferAddPulseFunc outFuncs[], BKInt maxFuncs) {
+	BKBufferAddPulseFunc funcs[4];
+	BKInt numFuncs = 0;
+
+	funcs[numFuncs++] = BKBufferAddPulseScalar;
+
+#if BK_USE_NEON
+	funcs[numFuncs++] = BKBufferAddPulseNEON;
+#endif
+#if BK_USE_SSE2
+	funcs[numFuncs++] = BKBufferAddPulseSSE2;
+#endif
+#if BK_USE_AVX2
+	if (__builtin_cpu_supports("avx2")) {
+		funcs[numFuncs++] = BKBufferAddPulseAVX2;
+	}
+#endif
+
+	numFuncs = BKMin(numFuncs, maxFuncs);
+	memcpy(outFuncs, funcs, numFuncs * sizeof(*funcs));
+
+	return numFuncs;
+}
+
+BKBufferAddPulseFunc BKBufferGetAddPulseFunc(void) {
+	BKBufferAddPulseFunc funcs[4];
+	BKInt numFuncs = BKBufferGetAddPulseFuncs(funcs, 4);
+
+	return funcs[numFuncs - 1];
+}
+
 BKInt BKBufferInit(BKBuffer* buf) {
 	memset(buf, 0, sizeof(BKBuffer));
-	BKBufferClear(buf);
 
 	buf->pulse = &BKBufferStepPhasesHarm;
+	buf->addPulse = BKBufferGetAddPulseFunc();
+
+	return BKBufferSetCapacity(buf, BK_DEFAULT_BUFFER_CAPACITY);
+}
+
+BKInt BKBufferSetCapacity(BKBuffer* buf, BKUInt capacity) {
+	BKUInt size = 1;
+	BKUInt oldSize = buf->frames ? buf->mask + 1 : 0;
+	BKUInt minSize = capacity + BK_BUFFER_RESERVE;
+
+	if (capacity < BK_DEFAULT_BUFFER_CAPACITY || capacity > BK_MAX_BUFFER_CAPACITY) {
+		return BK_INVALID_VALUE;
+	}
+
+	if (buf->capacity > capacity) {
+		return BK_INVALID_STATE;
+	}
+
+	while (size < minSize) {
+		size <<= 1;
+	}
+
+	if (size != oldSize) {
+		BKInt* frames = BKMemAlloc(sizeof(BKInt) * size);
+
+		if (!frames) {
+			return BK_ALLOCATION_ERROR;
+		}
+
+		memset(frames, 0, sizeof(BKInt) * size);
+
+		// copy frames in order
+		for (BKUInt i = 0; i < BKMin(size, oldSize); i++) {
+			frames[i] = buf->frames[(buf->head + i) & buf->mask];
+		}
+
+		BKMemFree(buf->frames);
+
+		buf->frames = frames;
+		buf->mask = size - 1;
+		buf->head = 0;
+	}
+
+	buf->maxCapacity = capacity;
 
 	return 0;
 }
 
 void BKBufferDispose(BKBuffer* buf) {
-	BKBufferClear(buf);
+	BKMemFree(buf->frames);
+	memset(buf, 0, sizeof(BKBuffer));
+}
+
+/**
+ * Clamp amplitude to frame range without branching
+ * Values exceeding the range are folded the same way as `(amp >> 16) ^ BK_FRAME_MAX`
+ */
+BK_INLINE BKFrame BKBufferClampFrame(BKInt amp) {
+	BKInt clamped = (amp >> BK_FRAME_SHIFT) ^ BK_FRAME_MAX;
+	BKInt mask = -((BKFrame)amp != amp);
+
+	return amp ^ ((amp ^ clamped) & mask);
+}
+
+/**
+ * Apply high pass filter and integrate next frame
+ */
+BK_INLINE BKInt BKBufferIntegrate(BKInt accum, BKInt frame) {
+	accum -= (accum >> (BK_INT_SHIFT - BK_HIGH_PASS_SHIFT)); // apply high pass filter
+	accum += frame;											 // accumulate
+
+	return accum;
+}
+
+/**
+ * Get frame from accumulator
+ */
+BK_INLINE BKFrame BKBufferOutputFrame(BKInt accum) {
+	return BKBufferClampFrame(accum >> (BK_INT_SHIFT - BK_FRAME_SHIFT - 2)); // remove fraction
+}
+
+/**
+ * Get float frame from accumulator
+ * Is not clamped and can exceed the range [-1.0, +1.0]
+ */
+BK_INLINE float BKBufferOutputFloat(BKInt accum) {
+	return (float)accum * BK_BUFFER_FLOAT_SCALE;
+}
+
+/**
+ * Remove `size` read frames
+ */
+static void BKBufferConsume(BKBuffer* buf, BKUInt size) {
+	BKUInt head = buf->head;
+	BKUInt tailSize = BKMin(size, buf->mask + 1 - head);
+
+	// zero read frames
+	memset(&buf->frames[head], 0, sizeof(BKInt) * tailSize);
+	memset(&buf->frames[0], 0, sizeof(BKInt) * (size - tailSize));
+
+	buf->head = (head + size) & buf->mask;
+	// reduce remaining capacity
+	buf->capacity -= size;
+
+	buf->offset -= size;
 }
 
 BKInt BKBufferRead(BKBuffer* buf, BKFrame outFrames[], BKUInt size, BKUInt interlace) {
-	BKInt* frames = &buf->frames[0];
+	BKInt const* frames = buf->frames;
+	BKUInt head = buf->head;
+	BKUInt mask = buf->mask;
 	BKInt accum = buf->accum;
+	BKUInt i = 0;
 
 	interlace = BKMax(interlace, 1);   // step must be at least 1
 	size = BKMin(size, buf->capacity); // can only read available frames
 
-	while (frames < &buf->frames[size]) {
-		accum -= (accum >> (BK_INT_SHIFT - BK_HIGH_PASS_SHIFT)); // apply high pass filter
-		accum += (*frames++);									 // accumulate
+	for (; i + 4 <= size; i += 4) {
+		accum = BKBufferIntegrate(accum, frames[(head + i + 0) & mask]);
+		outFrames[0] = BKBufferOutputFrame(accum);
+		accum = BKBufferIntegrate(accum, frames[(head + i + 1) & mask]);
+		outFrames[interlace] = BKBufferOutputFrame(accum);
+		accum = BKBufferIntegrate(accum, frames[(head + i + 2) & mask]);
+		outFrames[interlace * 2] = BKBufferOutputFrame(accum);
+		accum = BKBufferIntegrate(accum, frames[(head + i + 3) & mask]);
+		outFrames[interlace * 3] = BKBufferOutputFrame(accum);
+		outFrames += interlace * 4;
+	}
 
-		BKInt amp = accum >> (BK_INT_SHIFT - BK_FRAME_SHIFT - 2); // remove fraction
+	for (; i < size; i++) {
+		accum = BKBufferIntegrate(accum, frames[(head + i) & mask]);
+		(*outFrames) = BKBufferOutputFrame(accum);
+		outFrames += interlace;
+	}
+
+	buf->accum = accum;
+	BKBufferConsume(buf, size);
 
-		// clamp
-		if ((BKFrame)amp != amp) {
-			amp = (amp >> BK_FRAME_SHIFT) ^ BK_FRAME_MAX;
+	return size;
+}
+
+BKInt BKBufferReadInterlaced(BKBuffer bufs[], BKUInt numBufs, BKFrame outFrames[], BKUInt size) {
+	BKInt accums[BK_MAX_CHANNELS];
+
+	numBufs = BKMin(numBufs, BK_MAX_CHANNELS);
+
+	// can only read frames available in all buffers
+	for (BKUInt c = 0; c < numBufs; c++) {
+		size = BKMin(size, bufs[c].capacity);
+		accums[c] = bufs[c].accum;
+	}
+
+	switch (numBufs) {
+		case 1: {
+			BKBufferRead(&bufs[0], outFrames, size, 1);
+			return size;
 		}
+		case 2: {
+			BKInt const* left = bufs[0].frames;
+			BKInt const* right = bufs[1].frames;
+			BKUInt leftHead = bufs[0].head;
+			BKUInt rightHead = bufs[1].head;
+			BKUInt leftMask = bufs[0].mask;
+			BKUInt rightMask = bufs[1].mask;
+			BKInt accumLeft = accums[0];
+			BKInt accumRight = accums[1];
 
-		// write frame
-		(*outFrames) = amp;
-		outFrames += interlace;
+			for (BKUInt i = 0; i < size; i++) {
+				accumLeft = BKBufferIntegrate(accumLeft, left[(leftHead + i) & leftMask]);
+				accumRight = BKBufferIntegrate(accumRight, right[(rightHead + i) & rightMask]);
+				outFrames[0] = BKBufferOutputFrame(accumLeft);
+				outFrames[1] = BKBufferOutputFrame(accumRight);
+				outFrames += 2;
+			}
+
+			accums[0] = accumLeft;
+			accums[1] = accumRight;
+			break;
+		}
+		default: {
+			for (BKUInt i = 0; i < size; i++) {
+				for (BKUInt c = 0; c < numBufs; c++) {
+					accums[c] = BKBufferIntegrate(accums[c], bufs[c].frames[(bufs[c].head + i) & bufs[c].mask]);
+					(*outFrames++) = BKBufferOutputFrame(accums[c]);
+				}
+			}
+			break;
+		}
 	}
 
-	BKUInt bufferSize = buf->capacity + BK_STEP_WIDTH + 1;
+	for (BKUInt c = 0; c < numBufs; c++) {
+		bufs[c].accum = accums[c];
+		BKBufferConsume(&bufs[c], size);
+	}
 
-	// move frames left
-	memmove(&buf->frames[0], &buf->frames[size], sizeof(BKInt) * (bufferSize - size));
-	// zero right gap
-	memset(&buf->frames[bufferSize - size], 0, sizeof(BKInt) * size);
-	// reduce remaining capacity
-	buf->capacity -= size;
+	return size;
+}
+
+BKInt BKBufferReadFloat(BKBuffer* buf, float outFrames[], BKUInt size, BKUInt interlace) {
+	BKInt const* frames = buf->frames;
+	BKUInt head = buf->head;
+	BKUInt mask = buf->mask;
+	BKInt accum = buf->accum;
+
+	interlace = BKMax(interlace, 1);   // step must be at least 1
+	size = BKMin(size, buf->capacity); // can only read available frames
+
+	for (BKUInt i = 0; i < size; i++) {
+		accum = BKBufferIntegrate(accum, frames[(head + i) & mask]);
+		(*outFrames) = BKBufferOutputFloat(accum);
+		outFrames += interlace;
+	}
 
 	buf->accum = accum;
-	buf->time -= size << BK_FINT20_SHIFT;
+	BKBufferConsume(buf, size);
+
+	return size;
+}
+
+BKInt BKBufferReadInterlacedFloat(BKBuffer bufs[], BKUInt numBufs, float outFrames[], BKUInt size) {
+	BKInt accums[BK_MAX_CHANNELS];
+
+	numBufs = BKMin(numBufs, BK_MAX_CHANNELS);
+
+	// can only read frames available in all buffers
+	for (BKUInt c = 0; c < numBufs; c++) {
+		size = BKMin(size, bufs[c].capacity);
+		accums[c] = bufs[c].accum;
+	}
+
+	switch (numBufs) {
+		case 1: {
+			BKBufferReadFloat(&bufs[0], outFrames, size, 1);
+			return size;
+		}
+		case 2: {
+			BKInt const* left = bufs[0].frames;
+			BKInt const* right = bufs[1].frames;
+			BKUInt leftHead = bufs[0].head;
+			BKUInt rightHead = bufs[1].head;
+			BKUInt leftMask = bufs[0].mask;
+			BKUInt rightMask = bufs[1].mask;
+			BKInt accumLeft = accums[0];
+			BKInt accumRight = accums[1];
+
+			for (BKUInt i = 0; i < size; i++) {
+				accumLeft = BKBufferIntegrate(accumLeft, left[(leftHead + i) & leftMask]);
+				accumRight = BKBufferIntegrate(accumRight, right[(rightHead + i) & rightMask]);
+				outFrames[0] = BKBufferOutputFloat(accumLeft);
+				outFrames[1] = BKBufferOutputFloat(accumRight);
+				outFrames += 2;
+			}
+
+			accums[0] = accumLeft;
+			accums[1] = accumRight;
+			break;
+		}
+		default: {
+			for (BKUInt i = 0; i < size; i++) {
+				for (BKUInt c = 0; c < numBufs; c++) {
+					accums[c] = BKBufferIntegrate(accums[c], bufs[c].frames[(bufs[c].head + i) & bufs[c].mask]);
+					(*outFrames++) = BKBufferOutputFloat(accums[c]);
+				}
+			}
+			break;
+		}
+	}
+
+	for (BKUInt c = 0; c < numBufs; c++) {
+		bufs[c].accum = accums[c];
+		BKBufferConsume(&bufs[c], size);
+	}
 
 	return size;
 }
 
 void BKBufferClear(BKBuffer* buf) {
-	void const* pulse = buf->pulse;
+	BKBuffer copy = *buf;
 
 	memset(buf, 0, sizeof(BKBuffer));
-	buf->pulse = pulse;
+	buf->pulse = copy.pulse;
+	buf->addPulse = copy.addPulse;
+	buf->mask = copy.mask;
+	buf->maxCapacity = copy.maxCapacity;
+	buf->frames = copy.frames;
+
+	if (buf->frames) {
+		memset(buf->frames, 0, sizeof(BKInt) * (buf->mask + 1));
+	}
+}
+
+BKInt BKBufferSync(BKBuffer* buf, BKBuffer const* ref) {
+	if (buf->mask != ref->mask || buf->maxCapacity != ref->maxCapacity) {
+		buf->capacity = 0;
+
+		BKInt res = BKBufferSetCapacity(buf, ref->maxCapacity);
+
+		if (res < 0) {
+			return res;
+		}
+	}
+
+	buf->offset = ref->offset;
+	buf->time = ref->time;
+	buf->capacity = ref->capacity;
+	buf->head = ref->head;
+	buf->pulse = ref->pulse;
+
+	return 0;
+}
+
+void BKBufferMerge(BKBuffer* buf, BKBuffer* src) {
+	BKUInt head = src->head;
+	BKUInt mask = src->mask;
+	// pulses are written up to the pulse width beyond capacity
+	BKUInt size = BKMin(src->capacity + BK_STEP_WIDTH + 1, mask + 1);
+
+	for (BKUInt i = 0; i < size; i++) {
+		BKUInt j = (head + i) & mask;
+
+		buf->frames[j] += src->frames[j];
+		src->frames[j] = 0;
+	}
+
+	if (src->capacity > buf->capacity) {
+		buf->capacity = src->capacity;
+	}
 }
@@ -33,30 +33,49 @@
 #define BK_STEP_WIDTH 32
 #define BK_HIGH_PASS_SHIFT 23
 
-#define BK_BUFFER_CAPACITY ((1 << (BK_INT_SHIFT - BK_FINT20_SHIFT)) + BK_STEP_WIDTH + 1)
-
-#if BK_BUFFER_CAPACITY > 4129
-#error Capacity exceeds 4129?
-#endif
+// frames needed in addition to the capacity for units running ahead and pulse width
+#define BK_BUFFER_RESERVE ((BKUInt)(BK_MAX_RUN_PERIOD >> BK_FINT20_SHIFT) + 1 + BK_STEP_WIDTH + 1)
+// default capacity fits into a ring of 4096 frames
+#define BK_DEFAULT_BUFFER_CAPACITY ((1 << (BK_INT_SHIFT - BK_FINT20_SHIFT)) - BK_BUFFER_RESERVE)
+#define BK_MAX_BUFFER_CAPACITY (1 << 16)
+// deprecated; use `BK_DEFAULT_BUFFER_CAPACITY`
+#define BK_BUFFER_CAPACITY BK_DEFAULT_BUFFER_CAPACITY
 
 typedef struct BKBuffer BKBuffer;
 typedef struct BKBufferPulse BKBufferPulse;
 
+/**
+ * Add pulse kernel phase multiplied by `pulse` to `width` frames
+ * `width` is a multiple of 8
+ */
+typedef void (*BKBufferAddPulseFunc)(BKInt frames[], BKFrame const phase[], BKFrame pulse, BKUInt width);
+
 /**
  * Buffer
  */
 struct BKBuffer {
-	BKFUInt20 time;
+	BKUInt offset;					  // frame offset of current time
+	BKFUInt20 time;					  // frame fraction of current time
 	BKUInt capacity;				  // dynamic capacity
 	BKInt accum;					  // amplitude accumulator
-	BKInt frames[BK_BUFFER_CAPACITY]; // frame buffer
+	BKUInt head;					  // ring buffer index of first frame
+	BKUInt mask;					  // ring buffer size - 1
+	BKUInt maxCapacity;				  // maximum capacity
+	BKInt* frames;					  // frame ring buffer
 	BKBufferPulse const* pulse;		  // Pulse kernel
+	BKBufferAddPulseFunc addPulse;	  // Pulse kernel function
+	uint64_t numPulses;				  // number of pulses added; only updated with `BK_USE_PROFILING`
 };
 
 /**
  * Buffer pulse kernel
+ *
+ * Kernels narrower than `BK_STEP_WIDTH` are centered in `frames`
+ * and padded with zeros so every kernel has the same delay
  */
 struct BKBufferPulse {
+	BKUInt width;	 // number of taps: 8, 16 or 32
+	BKFUInt20 delay; // frames from first tap to center of step at phase 0
 	BKFrame frames[BK_STEP_UNIT][BK_STEP_WIDTH];
 };
 
@@ -65,11 +84,56 @@ struct BKBufferPulse {
  */
 extern BKBufferPulse const* const BKBufferPulseKernels[];
 
+/**
+ * Generate pulse kernel
+ *
+ * `kernel` is one of BK_PULSE_KERNEL_SINC or BK_PULSE_KERNEL_HARM
+ * `width` is the number of taps: 8, 16 or 32
+ * `cutoff` is the cutoff frequency relative to the Nyquist frequency in the range (0, 1]
+ *
+ * Fewer taps are faster but let through more aliasing
+ *
+ * Errors:
+ * BK_INVALID_VALUE if a value is invalid
+ */
+extern BKInt BKBufferPulseInit(BKBufferPulse* pulse, BKEnum kernel, BKUInt width, double cutoff);
+
+/**
+ * Check if pulse kernel can be used by buffers
+ */
+extern BKInt BKBufferPulseIsValid(BKBufferPulse const* pulse);
+
+/**
+ * Get pulse kernel functions supported by the current CPU
+ * The scalar function is first and the fastest function is last
+ * All functions give the same result
+ *
+ * Returns the number of functions written to `outFuncs`
+ */
+extern BKInt BKBufferGetAddPulseFuncs(BKBufferAddPulseFunc outFuncs[], BKInt maxFuncs);
+
+/**
+ * Get fastest pulse kernel function supported by the current CPU
+ * Used by `BKBufferInit`
+ */
+extern BKBufferAddPulseFunc BKBufferGetAddPulseFunc(void);
+
 /**
  * Initialize buffer
  */
 extern BKInt BKBufferInit(BKBuffer* buf);
 
+/**
+ * Set maximum number of frames the buffer can hold
+ * Buffers have a capacity of BK_DEFAULT_BUFFER_CAPACITY after initialization
+ *
+ * Errors:
+ * BK_INVALID_VALUE if capacity is not in range [BK_DEFAULT_BUFFER_CAPACITY, BK_MAX_BUFFER_CAPACITY]
+ * BK_INVALID_STATE if buffer contains more frames than `capacity`
+ * BK_ALLOCATION_ERROR if memory could not be allocated
+ */
+extern BKInt BKBufferSetCapacity(BKBuffer* buf, BKUInt capacity);
+
 /**
  * Dispose buffer
  */
@@ -78,28 +142,68 @@ extern void BKBufferDispose(BKBuffer* buf);
 /**
  * Add pulse at time offset
  */
-BK_INLINE BKInt BKBufferAddPulse(BKBuffer* buf, BKFUInt20 time, BKFrame pulse);
+BK_INLINE BKInt BKBufferAddPulse(BKBuffer* buf, BKFUInt64 time, BKFrame pulse);
+
+/**
+ * Add one pulse per buffer at time offset
+ * Buffers must have the same time, ring position and pulse kernel
+ * Zero pulses are skipped
+ */
+BK_INLINE BKInt BKBufferAddPulses(BKBuffer bufs[], BKUInt numBufs, BKFUInt64 time, BKFrame const pulses[]);
 
 /**
  * Add single frame at time offset
  */
-BK_INLINE BKInt BKBufferAddFrame(BKBuffer* buf, BKFUInt20 time, BKFrame frame);
+BK_INLINE BKInt BKBufferAddFrame(BKBuffer* buf, BKFUInt64 time, BKFrame frame);
+
+/**
+ * Add pulse without band limiting by splitting it linearly between two frames
+ * Has the same delay as `BKBufferAddPulse` with the buffer's pulse kernel
+ * Only suited for pulses following each other at frame distance
+ */
+BK_INLINE BKInt BKBufferAddStep(BKBuffer* buf, BKFUInt64 time, BKFrame pulse);
+
+/**
+ * Add steps between `size` consecutive levels at frame distance starting at time offset
+ * Levels are `frames` at distance `stride` scaled by `volume`
+ * The first step starts from `*lastLevel` which is set to the last level
+ * Same as calling `BKBufferAddStep` for each level but adds to each frame once
+ */
+BK_INLINE BKInt BKBufferAddSteps(BKBuffer* buf, BKFUInt64 time, BKFrame const frames[], BKUInt stride, BKUInt size, BKInt volume, BKInt* lastLevel);
 
 /**
  * Set time of last update
  */
-BK_INLINE BKInt BKBufferEnd(BKBuffer* buf, BKFUInt20 time);
+BK_INLINE BKInt BKBufferEnd(BKBuffer* buf, BKFUInt64 time);
 
 /**
  * Advance time
  */
-BK_INLINE BKInt BKBufferShift(BKBuffer* buf, BKFUInt20 time);
+BK_INLINE BKInt BKBufferShift(BKBuffer* buf, BKFUInt64 time);
 
 /**
  * Read frames
  */
 extern BKInt BKBufferRead(BKBuffer* buf, BKFrame outFrames[], BKUInt size, BKUInt interlace);
 
+/**
+ * Read frames of multiple buffers in a single pass
+ * Frames are interlaced into `outFrames` in order of `bufs`
+ * Reads only as many frames as available in all buffers
+ */
+extern BKInt BKBufferReadInterlaced(BKBuffer bufs[], BKUInt numBufs, BKFrame outFrames[], BKUInt size);
+
+/**
+ * Read float frames
+ * Frames are not clamped and may exceed the range [-1.0, +1.0]
+ */
+extern BKInt BKBufferReadFloat(BKBuffer* buf, float outFrames[], BKUInt size, BKUInt interlace);
+
+/**
+ * Read float frames of multiple buffers in a single pass
+ */
+extern BKInt BKBufferReadInterlacedFloat(BKBuffer bufs[], BKUInt numBufs, float outFrames[], BKUInt size);
+
 /**
  * Get current buffer size
  */
@@ -110,9 +214,24 @@ BK_INLINE BKInt BKBufferSize(BKBuffer const* buf);
  */
 extern void BKBufferClear(BKBuffer* buf);
 
-BK_INLINE BKInt BKBufferEnd(BKBuffer* buf, BKFUInt20 time) {
+/**
+ * Set time, capacity, ring position and pulse kernel of empty buffer `buf` to those of `ref`
+ * Allows frames to be added to `buf` and then be merged into `ref` with `BKBufferMerge`
+ *
+ * Errors:
+ * BK_ALLOCATION_ERROR if memory could not be allocated
+ */
+extern BKInt BKBufferSync(BKBuffer* buf, BKBuffer const* ref);
+
+/**
+ * Add frames of `src` to `buf` and clear them in `src`
+ * `src` must be synchronized to `buf` with `BKBufferSync`
+ */
+extern void BKBufferMerge(BKBuffer* buf, BKBuffer* src);
+
+BK_INLINE BKInt BKBufferEnd(BKBuffer* buf, BKFUInt64 time) {
 	time = buf->time + time;
-	BKUInt offset = time >> BK_FINT20_SHIFT;
+	BKUInt offset = buf->offset + (BKUInt)(time >> BK_FINT20_SHIFT);
 
 	if (offset > buf->capacity) {
 		buf->capacity = offset;
@@ -121,45 +240,164 @@ BK_INLINE BKInt BKBufferEnd(BKBuffer* buf, BKFUInt20 time) {
 	return 0;
 }
 
-BK_INLINE BKInt BKBufferShift(BKBuffer* buf, BKFUInt20 time) {
-	BKFUInt20 maxShift = buf->capacity << BK_FINT20_SHIFT;
+BK_INLINE BKInt BKBufferShift(BKBuffer* buf, BKFUInt64 time) {
+	time = buf->time + time;
+	BKUInt offset = buf->offset + (BKUInt)(time >> BK_FINT20_SHIFT);
 
-	if (buf->time + time > maxShift) {
-		time = maxShift - buf->time;
+	// can't shift beyond capacity
+	if ((time >> BK_FINT20_SHIFT) >= buf->capacity - buf->offset) {
+		buf->offset = buf->capacity;
+		buf->time = 0;
+	}
+	else {
+		buf->offset = offset;
+		buf->time = (BKFUInt20)time & BK_FINT20_FRAC;
 	}
-
-	buf->time += time;
 
 	return 0;
 }
 
 BK_INLINE BKInt BKBufferSize(BKBuffer const* buf) {
-	return buf->time >> BK_FINT20_SHIFT;
+	return buf->offset;
 }
 
-BK_INLINE BKInt BKBufferAddPulse(BKBuffer* buf, BKFUInt20 time, BKFrame pulse) {
+BK_INLINE BKInt BKBufferAddPulse(BKBuffer* buf, BKFUInt64 time, BKFrame pulse) {
 	time = buf->time + time;
-	BKUInt offset = time >> BK_FINT20_SHIFT;
+	BKUInt offset = buf->offset + (BKUInt)(time >> BK_FINT20_SHIFT);
 
-	BKUInt frac = time & BK_FINT20_FRAC;		// frame fraction
+	BKUInt frac = (BKFUInt20)time & BK_FINT20_FRAC; // frame fraction
 	frac >>= (BK_FINT20_SHIFT - BK_STEP_SHIFT); // step fraction
 
-	BKFrame const* phase = buf->pulse->frames[frac];
-	BKInt* frames = &buf->frames[offset];
+	BKUInt width = buf->pulse->width;
+	BKUInt start = (BK_STEP_WIDTH - width) >> 1; // skip zero padding
+	BKFrame const* phase = &buf->pulse->frames[frac][start];
+
+	offset = (buf->head + offset + start) & buf->mask;
 
 	// add step
-	for (BKInt i = 0; i < BK_STEP_WIDTH; i++) {
-		frames[i] += (BKInt)phase[i] * pulse;
+	if (offset <= buf->mask + 1 - width) {
+		buf->addPulse(&buf->frames[offset], phase, pulse, width);
+	}
+	// step wraps around ring buffer end
+	else {
+		for (BKUInt i = 0; i < width; i++) {
+			buf->frames[(offset + i) & buf->mask] += (BKInt)phase[i] * pulse;
+		}
 	}
 
+#if BK_USE_PROFILING
+	buf->numPulses++;
+#endif
+
+	return 0;
+}
+
+BK_INLINE BKInt BKBufferAddPulses(BKBuffer bufs[], BKUInt numBufs, BKFUInt64 time, BKFrame const pulses[]) {
+	BKBuffer* buf = &bufs[0];
+
+	time = buf->time + time;
+	BKUInt offset = buf->offset + (BKUInt)(time >> BK_FINT20_SHIFT);
+
+	BKUInt frac = (BKFUInt20)time & BK_FINT20_FRAC; // frame fraction
+	frac >>= (BK_FINT20_SHIFT - BK_STEP_SHIFT); // step fraction
+
+	BKUInt width = buf->pulse->width;
+	BKUInt start = (BK_STEP_WIDTH - width) >> 1; // skip zero padding
+	BKFrame const* phase = &buf->pulse->frames[frac][start];
+
+	offset = (buf->head + offset + start) & buf->mask;
+
+	// add step
+	if (offset <= buf->mask + 1 - width) {
+		for (BKUInt c = 0; c < numBufs; c++) {
+			if (pulses[c]) {
+				bufs[c].addPulse(&bufs[c].frames[offset], phase, pulses[c], width);
+			}
+		}
+	}
+	// step wraps around ring buffer end
+	else {
+		for (BKUInt c = 0; c < numBufs; c++) {
+			for (BKUInt i = 0; i < width && pulses[c]; i++) {
+				bufs[c].frames[(offset + i) & buf->mask] += (BKInt)phase[i] * pulses[c];
+			}
+		}
+	}
+
+#if BK_USE_PROFILING
+	for (BKUInt c = 0; c < numBufs; c++) {
+		bufs[c].numPulses += pulses[c] != 0;
+	}
+#endif
+
 	return 0;
 }
 
-BK_INLINE BKInt BKBufferAddFrame(BKBuffer* buf, BKFUInt20 time, BKFrame frame) {
+BK_INLINE BKInt BKBufferAddFrame(BKBuffer* buf, BKFUInt64 time, BKFrame frame) {
 	time = buf->time + time;
-	BKUInt offset = time >> BK_FINT20_SHIFT;
+	BKUInt offset = buf->offset + (BKUInt)(time >> BK_FINT20_SHIFT);
+
+	buf->frames[(buf->head + offset) & buf->mask] += BK_MAX_VOLUME * frame;
+
+#if BK_USE_PROFILING
+	buf->numPulses++;
+#endif
+
+	return 0;
+}
+
+BK_INLINE BKInt BKBufferAddStep(BKBuffer* buf, BKFUInt64 time, BKFrame pulse) {
+	time = buf->time + time + buf->pulse->delay;
+	BKUInt offset = buf->offset + (BKUInt)(time >> BK_FINT20_SHIFT);
+
+	BKUInt frac = ((BKFUInt20)time & BK_FINT20_FRAC) >> (BK_FINT20_SHIFT - 15); // 15 bit fraction
+	BKInt next = ((BKInt)BK_FRAME_MAX * frac) >> 15;
+
+	buf->frames[(buf->head + offset) & buf->mask] += ((BKInt)BK_FRAME_MAX - next) * pulse;
+	buf->frames[(buf->head + offset + 1) & buf->mask] += next * pulse;
+
+#if BK_USE_PROFILING
+	buf->numPulses++;
+#endif
+
+	return 0;
+}
+
+BK_INLINE BKInt BKBufferAddSteps(BKBuffer* buf, BKFUInt64 time, BKFrame const frames[], BKUInt stride, BKUInt size, BKInt volume, BKInt* lastLevel) {
+	time = buf->time + time + buf->pulse->delay;
+	BKUInt offset = buf->offset + (BKUInt)(time >> BK_FINT20_SHIFT);
+
+	BKUInt frac = ((BKFUInt20)time & BK_FINT20_FRAC) >> (BK_FINT20_SHIFT - 15); // 15 bit fraction
+	BKInt next = ((BKInt)BK_FRAME_MAX * frac) >> 15;
+	BKInt prev = (BKInt)BK_FRAME_MAX - next;
+
+	BKUInt index = (buf->head + offset) & buf->mask;
+	BKInt level = *lastLevel;
+	BKInt carry = 0; // part of previous step
+
+	for (BKUInt i = 0; i < size;) {
+		// split span at ring buffer end
+		BKUInt span = BKMin(size - i, buf->mask + 1 - index);
+		BKInt* out = &buf->frames[index];
+
+		for (BKUInt j = 0; j < span; j++, i++) {
+			BKInt value = (frames[i * stride] * volume) >> BK_VOLUME_SHIFT;
+			BKFrame pulse = value - level;
+			level = value;
+
+			out[j] += prev * pulse + carry;
+			carry = next * pulse;
+
+#if BK_USE_PROFILING
+			buf->numPulses += pulse != 0;
+#endif
+		}
+
+		index = (index + span) & buf->mask;
+	}
 
-	buf->frames[offset] += BK_MAX_VOLUME * frame;
+	buf->frames[index] += carry;
+	*lastLevel = level;
 
 	return 0;
 }
@@ -22,13 +22,15 @@
  */
 
 #include "BKClock.h"
-#include "BKContext.h"
+#include "BKContext_internal.h"
 
 enum {
 	BK_CLOCK_FLAG_RESET = 1 << 0,
 	BK_CLOCK_FLAG_COPY_MASK = 0,
 };
 
+#define BK_CLOCK_ORDER_STEP (1 << 10) // gap between appended clocks
+
 extern BKClass BKClockClass;
 extern BKClass BKDividerClass;
 
@@ -37,7 +39,7 @@ static BKInt BKClockInitGeneric(BKClock* clock, BKTime period, BKCallback* callb
 		clock->callback = (*callback);
 	}
 
-	clock->time = BK_TIME_ZERO;
+	clock->startTime = BK_TIME_ZERO;
 	clock->nextTime = BK_TIME_ZERO;
 	clock->period = period;
 
@@ -79,15 +81,71 @@ static void BKClockDisposeObject(BKClock* clock) {
 	}
 }
 
+/**
+ * Number clocks in list order leaving gaps for inserted clocks
+ */
+static void BKClockUpdateOrder(BKContext* ctx) {
+	BKUInt order = 0;
+
+	for (BKClock* clock = ctx->firstClock; clock; clock = clock->nextClock) {
+		order += BK_CLOCK_ORDER_STEP;
+		clock->order = order;
+	}
+
+	ctx->clockOrder = order;
+}
+
+/**
+ * Set order of linked clock between its neighbours
+ * Appended clocks take the next value of the insertion counter; clocks
+ * inserted before another clock take the middle of the gap before it
+ * Clocks are only renumbered if the counter overflows or the gap is used up
+ */
+static void BKClockSetOrder(BKContext* ctx, BKClock* clock) {
+	BKClock* prevClock = clock->prevClock;
+	BKClock* nextClock = clock->nextClock;
+
+	if (nextClock == NULL) {
+		BKUInt order = ctx->clockOrder + BK_CLOCK_ORDER_STEP;
+
+		// counter did not overflow
+		if (order > ctx->clockOrder) {
+			ctx->clockOrder = order;
+			clock->order = order;
+
+			return;
+		}
+	}
+	else {
+		BKUInt prevOrder = prevClock ? prevClock->order : 0;
+
+		if (nextClock->order - prevOrder > 1) {
+			clock->order = prevOrder + (nextClock->order - prevOrder) / 2;
+
+			return;
+		}
+	}
+
+	BKClockUpdateOrder(ctx);
+}
+
 BKInt BKClockAttach(BKClock* clock, BKContext* ctx, BKClock* beforeClock) {
 	if (clock->ctx == NULL) {
-		clock->ctx = ctx;
-		BKClockReset(clock);
-
 		if (beforeClock == BK_FIRST_ELEMENT_PTR) {
 			beforeClock = ctx->firstClock;
 		}
 
+		// previous clock must be in same context
+		if (beforeClock != NULL && beforeClock->ctx != ctx) {
+			return BK_INVALID_VALUE;
+		}
+
+		if (BKContextAddClock(ctx, clock) < 0) {
+			return BK_ALLOCATION_ERROR;
+		}
+
+		clock->ctx = ctx;
+
 		if (beforeClock == NULL) {
 			clock->prevClock = ctx->lastClock;
 			clock->nextClock = NULL;
@@ -102,8 +160,7 @@ BKInt BKClockAttach(BKClock* clock, BKContext* ctx, BKClock* beforeClock) {
 				ctx->lastClock = clock;
 			}
 		}
-		// previous clock must be in same context
-		else if (beforeClock->ctx == ctx) {
+		else {
 			clock->prevClock = beforeClock->prevClock;
 			clock->nextClock = beforeClock;
 
@@ -116,9 +173,10 @@ BKInt BKClockAttach(BKClock* clock, BKContext* ctx, BKClock* beforeClock) {
 
 			beforeClock->prevClock = clock;
 		}
-		else {
-			return BK_INVALID_VALUE;
-		}
+
+		// keeps relative order of other clocks
+		BKClockSetOrder(ctx, clock);
+		BKClockReset(clock);
 	}
 	else {
 		return BK_INVALID_STATE;
@@ -131,6 +189,8 @@ void BKClockDetach(BKClock* clock) {
 	BKContext* ctx = clock->ctx;
 
 	if (ctx) {
+		BKContextRemoveClock(ctx, clock);
+
 		if (clock->prevClock) {
 			clock->prevClock->nextClock = clock->nextClock;
 		}
@@ -159,22 +219,27 @@ void BKClockSetPeriod(BKClock* clock, BKTime period) {
 void BKClockReset(BKClock* clock) {
 	BKContext* ctx = clock->ctx;
 
-	if (ctx) {
-		ctx->flags |= BK_CONTEXT_FLAG_CLOCK_RESET;
-	}
-
 	for (BKDivider* divider = clock->dividers.firstDivider; divider; divider = divider->nextDivider) {
 		BKDividerReset(divider);
 	}
 
 	clock->object.flags &= ~BK_CLOCK_FLAG_RESET; // clear reset flag
 	clock->counter = 0;
-	clock->time = BK_TIME_ZERO;
-	clock->nextTime = BK_TIME_ZERO;
+
+	// tick at current time
+	if (ctx) {
+		clock->startTime = ctx->currentTime;
+		clock->nextTime = ctx->currentTime;
+		BKContextUpdateClock(ctx, clock);
+	}
+	else {
+		clock->startTime = BK_TIME_ZERO;
+		clock->nextTime = BK_TIME_ZERO;
+	}
 }
 
-void BKClockAdvance(BKClock* clock, BKFUInt20 period) {
-	clock->time = BKTimeAddFUInt20(clock->time, period);
+void BKClockAdvance(BKClock* clock, BKFUInt64 period) {
+	// clocks are scheduled by absolute tick time
 }
 
 BKInt BKDividerTick(BKDivider* divider, BKCallbackInfo* info) {
@@ -206,12 +271,13 @@ BKInt BKDividerTick(BKDivider* divider, BKCallbackInfo* info) {
 BKInt BKClockTick(BKClock* clock) {
 	BKInt result = 0;
 	BKCallbackInfo info;
+	BKContext* ctx = clock->ctx;
 
-	if (BKTimeIsEqual(clock->time, clock->nextTime)) {
+	if (ctx && BKTimeIsLessEqual(clock->nextTime, ctx->currentTime)) {
 		memset(&info, 0, sizeof(BKCallbackInfo));
 		info.object = clock;
 		info.event = BK_EVENT_CLOCK;
-		info.nextTime = clock->time;
+		info.nextTime = BKTimeSub(ctx->currentTime, clock->startTime);
 
 		if (clock->callback.func) {
 			result = clock->callback.func(&info, clock->callback.userInfo);
@@ -221,15 +287,25 @@ BKInt BKClockTick(BKClock* clock) {
 
 		clock->counter++;
 
+		// clock was detached by callback
+		if (clock->ctx != ctx) {
+			return result;
+		}
+
+		// clock time since last reset
+		BKTime time = BKTimeSub(ctx->currentTime, clock->startTime);
+
 		// set next time and new period from callback
-		if (BKTimeIsGreater(info.nextTime, clock->time)) {
-			clock->period = BKTimeSub(info.nextTime, clock->time);
-			clock->nextTime = info.nextTime;
+		if (BKTimeIsGreater(info.nextTime, time)) {
+			clock->period = BKTimeSub(info.nextTime, time);
+			clock->nextTime = BKTimeAdd(clock->startTime, info.nextTime);
 		}
 		// set next period
 		else {
-			clock->nextTime = BKTimeAdd(clock->time, clock->period);
+			clock->nextTime = BKTimeAdd(ctx->currentTime, clock->period);
 		}
+
+		BKContextUpdateClock(ctx, clock);
 	}
 
 	return result;
@@ -61,9 +61,11 @@ struct BKClock {
 	BKClock* prevClock;
 	BKClock* nextClock;
 	BKTime period;
-	BKTime time;
-	BKTime nextTime;
+	BKTime startTime; // absolute context time of last reset
+	BKTime nextTime;  // absolute context time of next tick
 	BKUInt counter;
+	BKUInt order;	  // position in clock list
+	BKUInt heapIndex; // position in context scheduler
 	BKCallback callback;
 	BKDividerGroup dividers;
 };
@@ -82,9 +84,11 @@ extern BKInt BKClockAlloc(BKClock** outClock, BKTime period, BKCallback* callbac
  * Attach clock
  * If `beforeClock` is not NULL `clock` is attached before `beforeClock`
  * `beforeClock` can have the values BK_LAST_ELEMENT_PTR and BK_FIRST_ELEMENT_PTR
+ * Clocks ticking at the same time are ticked in list order
  *
  * Errors:
  * BK_INVALID_STATE if clock is already attached to a context
+ * BK_ALLOCATION_ERROR if memory could not be allocated
  */
 extern BKInt BKClockAttach(BKClock* clock, BKContext* ctx, BKClock* beforeClock);
 
@@ -104,12 +108,14 @@ extern void BKClockSetPeriod(BKClock* clock, BKTime period);
 extern void BKClockReset(BKClock* clock);
 
 /**
- * Advance clock by time
+ * Does nothing
+ * Clocks are scheduled by the context at their absolute tick time
  */
-extern void BKClockAdvance(BKClock* clock, BKFUInt20 period);
+extern void BKClockAdvance(BKClock* clock, BKFUInt64 period) BK_DEPRECATED_FUNC("Clocks do not need to be advanced anymore");
 
 /**
- * Tick clock and attached dividers
+ * Tick clock and attached dividers if the context time has reached its next tick time
+ * `nextTime` of the callback info is relative to the time the clock was reset
  */
 extern BKInt BKClockTick(BKClock* clock);
 
@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2012-2015 Simon Schoenenberger
+ * http://blipkit.audio
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "BKCommandQueue.h"
+#include "BKAllocator.h"
+#include <stdatomic.h>
+
+struct BKCommandQueue {
+	atomic_uint head; // index of next command to read
+	atomic_uint tail; // index of next command to write
+	BKUInt mask;
+	BKCommand commands[];
+};
+
+BKInt BKCommandQueueAlloc(BKCommandQueue** outQueue, BKUInt capacity) {
+	BKUInt size = 1;
+	BKCommandQueue* queue;
+
+	while (size < capacity) {
+		size <<= 1;
+	}
+
+	queue = BKMemAlloc(sizeof(*queue) + size * sizeof(BKCommand));
+
+	if (queue == NULL) {
+		*outQueue = NULL;
+		return BK_ALLOCATION_ERROR;
+	}
+
+	atomic_init(&queue->head, 0);
+	atomic_init(&queue->tail, 0);
+	queue->mask = size - 1;
+
+	*outQueue = queue;
+
+	return 0;
+}
+
+void BKCommandQueueFree(BKCommandQueue* queue) {
+	BKMemFree(queue);
+}
+
+BKInt BKCommandQueuePush(BKCommandQueue* queue, BKCommand const* command) {
+	BKUInt tail = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+	BKUInt head = atomic_load_explicit(&queue->head, memory_order_acquire);
+
+	if (tail - head > queue->mask) {
+		return BK_INVALID_STATE;
+	}
+
+	queue->commands[tail & queue->mask] = *command;
+	atomic_store_explicit(&queue->tail, tail + 1, memory_order_release);
+
+	return 0;
+}
+
+BKCommand const* BKCommandQueuePeek(BKCommandQueue* queue) {
+	BKUInt head = atomic_load_explicit(&queue->head, memory_order_relaxed);
+	BKUInt tail = atomic_load_explicit(&queue->tail, memory_order_acquire);
+
+	if (head == tail) {
+		return NULL;
+	}
+
+	return &queue->commands[head & queue->mask];
+}
+
+void BKCommandQueuePop(BKCommandQueue* queue) {
+	BKUInt head = atomic_load_explicit(&queue->head, memory_order_relaxed);
+
+	atomic_store_explicit(&queue->head, head + 1, memory_order_release);
+}
@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2012-2015 Simon Schoenenberger
+ * http://blipkit.audio
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef _BK_COMMAND_QUEUE_H_
+#define _BK_COMMAND_QUEUE_H_
+
+#include "BKTime.h"
+
+#define BK_DEFAULT_COMMAND_QUEUE_CAPACITY 256
+
+typedef struct BKCommand BKCommand;
+typedef struct BKCommandQueue BKCommandQueue;
+
+/**
+ * Command types
+ */
+enum {
+	BK_COMMAND_SET_ATTR,
+	BK_COMMAND_SET_PTR,
+};
+
+/**
+ * Attribute change of an object at an absolute context time
+ */
+struct BKCommand {
+	BKTime time;
+	BKEnum type;
+	void* object;
+	BKEnum attr;
+	BKInt value;
+	void* ptr;
+	BKSize size;
+};
+
+/**
+ * Allocate single-producer single-consumer queue
+ * `capacity` is rounded up to the next power of 2
+ *
+ * Errors:
+ * BK_ALLOCATION_ERROR if memory could not be allocated
+ */
+extern BKInt BKCommandQueueAlloc(BKCommandQueue** outQueue, BKUInt capacity);
+
+/**
+ * Free queue
+ */
+extern void BKCommandQueueFree(BKCommandQueue* queue);
+
+/**
+ * Add command to end of queue
+ * Must only be called by the producer thread
+ *
+ * Errors:
+ * BK_INVALID_STATE if queue is full
+ */
+extern BKInt BKCommandQueuePush(BKCommandQueue* queue, BKCommand const* command);
+
+/**
+ * Get first command or NULL if queue is empty
+ * Must only be called by the consumer thread
+ */
+extern BKCommand const* BKCommandQueuePeek(BKCommandQueue* queue);
+
+/**
+ * Remove first command
+ * Must only be called by the consumer thread after `BKCommandQueuePeek` returned a command
+ */
+extern void BKCommandQueuePop(BKCommandQueue* queue);
+
+#endif /* ! _BK_COMMAND_QUEUE_H_ */
@@ -21,15 +21,24 @@
  * IN THE SOFTWARE.
  */
 
-#include "BKContext.h"
-#include "BKUnit.h"
+#include "BKAllocator.h"
+#include "BKContext_internal.h"
+#include "BKUnit_internal.h"
 #ifdef HAVE_ALLOCA_H // Assume GNU.
 #include <alloca.h>
 #elif HAVE_MALLOC_H // Assume MSVC.
 #include <malloc.h>
 #endif
 
-extern BKInt BKContextSetAttrInt(BKContext* ctx, BKEnum attr, BKInt value);
+/**
+ * Output formats of `BKContextReadFormat`
+ */
+enum {
+	BK_CONTEXT_FORMAT_INT16,
+	BK_CONTEXT_FORMAT_FLOAT,
+	BK_CONTEXT_FORMAT_INT16_PLANAR,
+	BK_CONTEXT_FORMAT_FLOAT_PLANAR,
+};
 
 extern BKClass BKContextClass;
 
@@ -56,7 +65,7 @@ static void BKContextUpdateMasterClocks(BKContext* ctx) {
 static BKInt BKContextInitGeneric(BKContext* ctx, BKUInt numChannels, BKUInt sampleRate) {
 	ctx->sampleRate = BKClamp(sampleRate, BK_MIN_SAMPLE_RATE, BK_MAX_SAMPLE_RATE);
 	ctx->numChannels = BKClamp(numChannels, 1, BK_MAX_CHANNELS);
-	ctx->channels = malloc(sizeof(BKBuffer) * ctx->numChannels);
+	ctx->channels = BKMemCalloc(ctx->numChannels, sizeof(BKBuffer));
 
 	BKContextUpdateMasterClocks(ctx);
 
@@ -64,6 +73,10 @@ static BKInt BKContextInitGeneric(BKContext* ctx, BKUInt numChannels, BKUInt sam
 		return BK_ALLOCATION_ERROR;
 	}
 
+	if (BKCommandQueueAlloc(&ctx->commands, BK_DEFAULT_COMMAND_QUEUE_CAPACITY) < 0) {
+		return BK_ALLOCATION_ERROR;
+	}
+
 	for (BKInt i = 0; i < ctx->numChannels; i++) {
 		BKBuffer* channel = &ctx->channels[i];
 
@@ -99,6 +112,303 @@ extern BKInt BKContextAlloc(BKContext** outCtx, BKUInt numChannels, BKUInt sampl
 	return 0;
 }
 
+/**
+ * Run unit and update its render counters
+ */
+static void BKContextRunUnit(BKUnit* unit, BKFUInt64 endTime) {
+#if BK_USE_PROFILING
+	BKInt numChannels = unit->ctx->numChannels;
+	BKFUInt64 startTime = unit->time;
+	uint64_t numPulses = 0;
+	uint64_t start = BKProfileTime();
+
+	for (BKInt i = 0; i < numChannels; i++) {
+		numPulses -= unit->channels[i].numPulses;
+	}
+
+	unit->run(unit, endTime);
+
+	for (BKInt i = 0; i < numChannels; i++) {
+		numPulses += unit->channels[i].numPulses;
+	}
+
+	unit->profile.numRuns++;
+	unit->profile.numPulses += numPulses;
+	unit->profile.numFrames += (unit->time >> BK_FINT20_SHIFT) - (startTime >> BK_FINT20_SHIFT);
+	unit->profile.runTime += BKProfileTime() - start;
+#else
+	unit->run(unit, endTime);
+#endif
+}
+
+/**
+ * Render units assigned to worker `index`
+ */
+static void BKContextRunWorker(BKContext* ctx, BKUInt index) {
+	BKUInt numWorkers = BKWorkerPoolSize(ctx->workers);
+	BKUInt start = index * ctx->numWorkerUnits / numWorkers;
+	BKUInt end = (index + 1) * ctx->numWorkerUnits / numWorkers;
+
+	for (BKUInt i = start; i < end; i++) {
+		BKContextRunUnit(ctx->workerUnits[i], ctx->workerEndTime);
+	}
+}
+
+static void BKContextFreeWorkers(BKContext* ctx) {
+	if (ctx->workers) {
+		BKUInt numChannels = (BKWorkerPoolSize(ctx->workers) - 1) * ctx->numChannels;
+
+		for (BKUInt i = 0; i < numChannels; i++) {
+			BKBufferDispose(&ctx->workerChannels[i]);
+		}
+
+		BKWorkerPoolFree(ctx->workers);
+		BKMemFree(ctx->workerChannels);
+		BKMemFree(ctx->workerUnits);
+		ctx->workers = NULL;
+		ctx->workerChannels = NULL;
+		ctx->workerUnits = NULL;
+		ctx->numWorkerUnits = 0;
+		ctx->workerUnitsCapacity = 0;
+	}
+}
+
+static BKInt BKContextSetNumWorkers(BKContext* ctx, BKInt numWorkers) {
+	BKWorkerPool* workers;
+	BKUInt numChannels = (numWorkers - 1) * ctx->numChannels;
+
+	if (numWorkers < 1 || numWorkers > BK_MAX_WORKERS) {
+		return BK_INVALID_VALUE;
+	}
+
+	BKContextFreeWorkers(ctx);
+
+	// render on calling thread
+	if (numWorkers == 1) {
+		return 0;
+	}
+
+	BKInt res = BKWorkerPoolAlloc(&workers, numWorkers, (BKWorkerFunc)BKContextRunWorker, ctx);
+
+	if (res < 0) {
+		return res;
+	}
+
+	ctx->workers = workers;
+	ctx->workerChannels = BKMemCalloc(numChannels, sizeof(BKBuffer));
+
+	if (ctx->workerChannels == NULL) {
+		BKContextFreeWorkers(ctx);
+		return BK_ALLOCATION_ERROR;
+	}
+
+	for (BKUInt i = 0; i < numChannels; i++) {
+		if (BKBufferInit(&ctx->workerChannels[i]) < 0) {
+			BKContextFreeWorkers(ctx);
+			return BK_ALLOCATION_ERROR;
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * Synchronize worker channels with context channels
+ */
+static BKInt BKContextBeginWorkers(BKContext* ctx) {
+	BKUInt numChannels = (BKWorkerPoolSize(ctx->workers) - 1) * ctx->numChannels;
+
+	for (BKUInt j = 0; j < numChannels; j++) {
+		BKInt res = BKBufferSync(&ctx->workerChannels[j], &ctx->channels[j % ctx->numChannels]);
+
+		if (res < 0) {
+			return res;
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * Sum worker channels into context channels
+ */
+static void BKContextEndWorkers(BKContext* ctx) {
+	BKUInt numChannels = (BKWorkerPoolSize(ctx->workers) - 1) * ctx->numChannels;
+
+	for (BKUInt j = 0; j < numChannels; j++) {
+		BKBufferMerge(&ctx->channels[j % ctx->numChannels], &ctx->workerChannels[j]);
+	}
+
+	for (BKUnit* unit = ctx->firstActiveUnit; unit; unit = unit->nextActiveUnit) {
+		unit->channels = ctx->channels;
+	}
+}
+
+void BKContextWakeUnit(BKContext* ctx, BKUnit* unit) {
+	if (unit->object.flags & BKUnitFlagActive) {
+		return;
+	}
+
+	// sleeping units are not rendered by workers; woken after workers have finished
+	if (ctx->flags & BK_CONTEXT_FLAG_WORKERS_RUNNING) {
+		unit->object.flags |= BKUnitFlagWakePending;
+		return;
+	}
+
+	unit->prevActiveUnit = ctx->lastActiveUnit;
+	unit->nextActiveUnit = NULL;
+
+	if (ctx->lastActiveUnit) {
+		ctx->lastActiveUnit->nextActiveUnit = unit;
+	}
+	// is first unit
+	else {
+		ctx->firstActiveUnit = unit;
+	}
+
+	ctx->lastActiveUnit = unit;
+
+	// phase was not advanced while sleeping
+	unit->object.flags |= BKUnitFlagActive;
+	unit->channels = ctx->channels;
+	unit->time = ctx->deltaTime;
+}
+
+void BKContextSleepUnit(BKContext* ctx, BKUnit* unit) {
+	if (!(unit->object.flags & BKUnitFlagActive)) {
+		return;
+	}
+
+	if (unit->prevActiveUnit) {
+		unit->prevActiveUnit->nextActiveUnit = unit->nextActiveUnit;
+	}
+	// is first unit
+	else {
+		ctx->firstActiveUnit = unit->nextActiveUnit;
+	}
+
+	if (unit->nextActiveUnit) {
+		unit->nextActiveUnit->prevActiveUnit = unit->prevActiveUnit;
+	}
+	// is last unit
+	else {
+		ctx->lastActiveUnit = unit->prevActiveUnit;
+	}
+
+	unit->object.flags &= ~BKUnitFlagActive;
+	unit->prevActiveUnit = NULL;
+	unit->nextActiveUnit = NULL;
+}
+
+/**
+ * Assign active units to workers
+ * Units may have been attached or woken by clock callbacks
+ */
+static BKInt BKContextAssignWorkerUnits(BKContext* ctx, BKInt* outHasCallbacks) {
+	BKUInt numWorkers = BKWorkerPoolSize(ctx->workers);
+	BKUInt numUnits = 0;
+	BKInt hasCallbacks = 0;
+
+	for (BKUnit* unit = ctx->firstActiveUnit; unit; unit = unit->nextActiveUnit) {
+		if (numUnits >= ctx->workerUnitsCapacity) {
+			BKUInt capacity = BKMax(ctx->workerUnitsCapacity * 2, 16);
+			BKUnit** units = BKMemRealloc(ctx->workerUnits, capacity * sizeof(BKUnit*));
+
+			if (!units) {
+				return BK_ALLOCATION_ERROR;
+			}
+
+			ctx->workerUnits = units;
+			ctx->workerUnitsCapacity = capacity;
+		}
+
+		ctx->workerUnits[numUnits++] = unit;
+		hasCallbacks |= unit->sample.callback.func != NULL;
+	}
+
+	// worker 0 renders into context channels
+	for (BKUInt index = 0; index < numWorkers; index++) {
+		BKUInt start = index * numUnits / numWorkers;
+		BKUInt end = (index + 1) * numUnits / numWorkers;
+		BKBuffer* channels = index ? &ctx->workerChannels[(index - 1) * ctx->numChannels] : ctx->channels;
+
+		for (BKUInt i = start; i < end; i++) {
+			ctx->workerUnits[i]->channels = channels;
+		}
+	}
+
+	ctx->numWorkerUnits = numUnits;
+	*outHasCallbacks = hasCallbacks;
+
+	return 0;
+}
+
+/**
+ * Wake and run units woken by sample callbacks on workers
+ */
+static void BKContextRunWokenUnits(BKContext* ctx, BKFUInt64 endTime) {
+	BKUnit* lastUnit = ctx->lastActiveUnit;
+
+	for (BKUnit* unit = ctx->firstUnit; unit; unit = unit->nextUnit) {
+		if (unit->object.flags & BKUnitFlagWakePending) {
+			unit->object.flags &= ~BKUnitFlagWakePending;
+			BKContextWakeUnit(ctx, unit);
+		}
+	}
+
+	// units woken by these units are appended and run as well
+	for (BKUnit* unit = lastUnit ? lastUnit->nextActiveUnit : ctx->firstActiveUnit; unit; unit = unit->nextActiveUnit) {
+		BKContextRunUnit(unit, endTime);
+	}
+}
+
+/**
+ * Run units on calling thread or on workers
+ */
+static BKInt BKContextRunUnits(BKContext* ctx, BKFUInt64 endTime) {
+	BKUnit* nextUnit;
+
+	if (ctx->workers) {
+		BKInt hasCallbacks = 0;
+		BKInt res = BKContextAssignWorkerUnits(ctx, &hasCallbacks);
+
+		if (res < 0) {
+			return res;
+		}
+
+		ctx->workerEndTime = endTime;
+		ctx->flags |= BK_CONTEXT_FLAG_WORKERS_RUNNING;
+		BKWorkerPoolRun(ctx->workers);
+		ctx->flags &= ~BK_CONTEXT_FLAG_WORKERS_RUNNING;
+
+		if (hasCallbacks) {
+			BKContextRunWokenUnits(ctx, endTime);
+		}
+
+		for (BKUnit* unit = ctx->firstActiveUnit; unit; unit = nextUnit) {
+			nextUnit = unit->nextActiveUnit;
+
+			if (unit->idle(unit)) {
+				BKContextSleepUnit(ctx, unit);
+			}
+		}
+	}
+	else {
+		for (BKUnit* unit = ctx->firstActiveUnit; unit; unit = nextUnit) {
+			BKContextRunUnit(unit, endTime);
+			// units woken while running are appended and run as well
+			nextUnit = unit->nextActiveUnit;
+
+			// idle units are not run until woken up by an attribute change
+			if (unit->idle(unit)) {
+				BKContextSleepUnit(ctx, unit);
+			}
+		}
+	}
+
+	return 0;
+}
+
 static void BKContextDisposeObject(BKContext* ctx) {
 	BKUnit* nextUnit;
 	BKClock* nextClock;
@@ -113,12 +423,18 @@ static void BKContextDisposeObject(BKContext* ctx) {
 		BKClockDetach(clock);
 	}
 
-	for (BKInt i = 0; i < ctx->numChannels; i++) {
-		BKBuffer* channel = &ctx->channels[i];
-		BKBufferDispose(channel);
+	if (ctx->channels) {
+		for (BKInt i = 0; i < ctx->numChannels; i++) {
+			BKBuffer* channel = &ctx->channels[i];
+			BKBufferDispose(channel);
+		}
 	}
 
-	free(ctx->channels);
+	BKMemFree(ctx->channels);
+	BKMemFree(ctx->clockHeap);
+	BKMemFree(ctx->events);
+	BKCommandQueueFree(ctx->commands);
+	BKContextFreeWorkers(ctx);
 	BKDispose(&ctx->masterClock);
 }
 
@@ -132,7 +448,37 @@ BKInt BKContextSetAttrInt(BKContext* ctx, BKEnum attr, BKInt value) {
 					unit->funcs->setAttr(unit, attr, value);
 				}
 			}*/
+			return BK_INVALID_ATTRIBUTE;
+			break;
+		}
+		case BK_CONTEXT_BUFFER_CAPACITY: {
+			BKUInt oldCapacity = ctx->channels[0].maxCapacity;
+
+			for (BKInt i = 0; i < ctx->numChannels; i++) {
+				BKInt res = BKBufferSetCapacity(&ctx->channels[i], value);
+
+				if (res < 0) {
+					// keep larger frame rings of previous channels but reset capacity
+					for (BKInt j = 0; j < i; j++) {
+						ctx->channels[j].maxCapacity = oldCapacity;
+					}
+
+					return res;
+				}
+			}
+
+			break;
 		}
+		case BK_NUM_THREADS: {
+			return BKContextSetNumWorkers(ctx, value);
+			break;
+		}
+#if BK_USE_PROFILING
+		case BK_PROFILE: {
+			memset(&ctx->profile, 0, sizeof(ctx->profile));
+			break;
+		}
+#endif
 		default: {
 			return BK_INVALID_ATTRIBUTE;
 			break;
@@ -146,7 +492,7 @@ BKInt BKContextSetAttr(BKContext* ctx, BKEnum attr, BKInt value) {
 	return BKContextSetAttrInt(ctx, attr, value);
 }
 
-static BKInt BKContextGetAttrInt(BKContext const* ctx, BKEnum attr, BKInt* outValue) {
+BKInt BKContextGetAttrInt(BKContext const* ctx, BKEnum attr, BKInt* outValue) {
 	BKInt value = 0;
 
 	switch (attr) {
@@ -158,6 +504,14 @@ static BKInt BKContextGetAttrInt(BKContext const* ctx, BKEnum attr, BKInt* outVa
 			value = ctx->sampleRate;
 			break;
 		}
+		case BK_CONTEXT_BUFFER_CAPACITY: {
+			value = ctx->channels[0].maxCapacity;
+			break;
+		}
+		case BK_NUM_THREADS: {
+			value = ctx->workers ? BKWorkerPoolSize(ctx->workers) : 1;
+			break;
+		}
 		default: {
 			return BK_INVALID_ATTRIBUTE;
 			break;
@@ -193,6 +547,9 @@ static BKInt BKContextSetPtrObj(BKContext* ctx, BKEnum attr, void* ptr, BKSize s
 			if (!pulse) {
 				pulse = BKBufferPulseKernels[BK_PULSE_KERNEL_HARM];
 			}
+			else if (!BKBufferPulseIsValid(pulse)) {
+				return BK_INVALID_VALUE;
+			}
 
 			for (BKInt i = 0; i < ctx->numChannels; i++) {
 				BKBuffer* channel = &ctx->channels[i];
@@ -231,6 +588,13 @@ static BKInt BKContextGetPtrObj(BKContext const* ctx, BKEnum attr, void* outPtr,
 			*pulseRef = ctx->channels[0].pulse;
 			break;
 		}
+#if BK_USE_PROFILING
+		case BK_PROFILE: {
+			BKContextProfile* profileRef = outPtr;
+			*profileRef = ctx->profile;
+			break;
+		}
+#endif
 		default: {
 			return BK_INVALID_ATTRIBUTE;
 			break;
@@ -244,25 +608,83 @@ BKInt BKContextGetPtr(BKContext const* ctx, BKEnum attr, void* outPtr) {
 	return BKContextGetPtrObj(ctx, attr, outPtr, 0);
 }
 
-BKInt BKContextGenerate(BKContext* ctx, BKFrame outFrames[], BKUInt size) {
+/**
+ * Read frames in given format
+ * `offset` is the number of frames already written to `outFrames`
+ */
+static BKInt BKContextReadFormatChannels(BKContext* ctx, void* outFrames, BKUInt offset, BKUInt size, BKEnum format) {
+	BKUInt numChannels = ctx->numChannels;
+
+	switch (format) {
+		case BK_CONTEXT_FORMAT_INT16: {
+			return BKBufferReadInterlaced(ctx->channels, numChannels, &((BKFrame*)outFrames)[offset * numChannels], size);
+		}
+		case BK_CONTEXT_FORMAT_FLOAT: {
+			return BKBufferReadInterlacedFloat(ctx->channels, numChannels, &((float*)outFrames)[offset * numChannels], size);
+		}
+		case BK_CONTEXT_FORMAT_INT16_PLANAR:
+		case BK_CONTEXT_FORMAT_FLOAT_PLANAR: {
+			// can only read frames available in all channels
+			for (BKInt i = 0; i < numChannels; i++) {
+				size = BKMin(size, ctx->channels[i].capacity);
+			}
+
+			for (BKInt i = 0; i < numChannels; i++) {
+				BKBuffer* channel = &ctx->channels[i];
+
+				if (format == BK_CONTEXT_FORMAT_FLOAT_PLANAR) {
+					BKBufferReadFloat(channel, &((float**)outFrames)[i][offset], size, 1);
+				}
+				else {
+					BKBufferRead(channel, &((BKFrame**)outFrames)[i][offset], size, 1);
+				}
+			}
+
+			return size;
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * Read frames and update read counters
+ */
+static BKInt BKContextReadFormat(BKContext* ctx, void* outFrames, BKUInt offset, BKUInt size, BKEnum format) {
+#if BK_USE_PROFILING
+	uint64_t start = BKProfileTime();
+	BKInt result = BKContextReadFormatChannels(ctx, outFrames, offset, size, format);
+
+	ctx->profile.numReads++;
+	ctx->profile.numReadFrames += BKMax(result, 0);
+	ctx->profile.readTime += BKProfileTime() - start;
+
+	return result;
+#else
+	return BKContextReadFormatChannels(ctx, outFrames, offset, size, format);
+#endif
+}
+
+static BKInt BKContextGenerateFormat(BKContext* ctx, void* outFrames, BKUInt size, BKEnum format) {
 	BKUInt remainingSize = size;
 	BKUInt writeSize = 0;
+	BKUInt maxChunkSize = ctx->channels[0].maxCapacity;
 
 	do {
 		BKUInt chunkSize = remainingSize;
 
-		if (chunkSize > BK_MAX_GENERATE_SAMPLES) {
-			chunkSize = BK_MAX_GENERATE_SAMPLES;
+		if (chunkSize > maxChunkSize) {
+			chunkSize = maxChunkSize;
 		}
 
-		BKUInt endTime = chunkSize << BK_FINT20_SHIFT;
+		BKFUInt64 endTime = (BKFUInt64)chunkSize << BK_FINT20_SHIFT;
 		BKInt result = BKContextEnd(ctx, endTime);
 
 		if (result < 0) {
 			return result;
 		}
 
-		chunkSize = BKContextRead(ctx, outFrames, chunkSize);
+		chunkSize = BKContextReadFormat(ctx, outFrames, writeSize, chunkSize, format);
 
 		writeSize += chunkSize;
 
@@ -272,143 +694,508 @@ BKInt BKContextGenerate(BKContext* ctx, BKFrame outFrames[], BKUInt size) {
 		}
 
 		remainingSize -= chunkSize;
-		outFrames += chunkSize * ctx->numChannels;
 	}
 	while (remainingSize);
 
 	return writeSize;
 }
 
+BKInt BKContextGenerate(BKContext* ctx, BKFrame outFrames[], BKUInt size) {
+	return BKContextGenerateFormat(ctx, outFrames, size, BK_CONTEXT_FORMAT_INT16);
+}
+
+BKInt BKContextGenerateFloat(BKContext* ctx, float outFrames[], BKUInt size) {
+	return BKContextGenerateFormat(ctx, outFrames, size, BK_CONTEXT_FORMAT_FLOAT);
+}
+
+BKInt BKContextGeneratePlanar(BKContext* ctx, BKFrame* outFrames[], BKUInt size) {
+	return BKContextGenerateFormat(ctx, outFrames, size, BK_CONTEXT_FORMAT_INT16_PLANAR);
+}
+
+BKInt BKContextGenerateFloatPlanar(BKContext* ctx, float* outFrames[], BKUInt size) {
+	return BKContextGenerateFormat(ctx, outFrames, size, BK_CONTEXT_FORMAT_FLOAT_PLANAR);
+}
+
 BKInt BKContextGenerateToTime(BKContext* ctx, BKTime endTime, BKInt (*write)(BKFrame inFrames[], BKUInt size, void* info), void* info) {
 	BKInt numFrames = 0;
-	BKFrame* frames = (BKFrame*)alloca(sizeof(BKFrame) * ctx->numChannels * BK_MAX_GENERATE_SAMPLES);
+	BKInt result = 0;
+	BKUInt maxChunkSize = ctx->channels[0].maxCapacity;
+	BKFrame* frames = BKMemAlloc(sizeof(BKFrame) * ctx->numChannels * maxChunkSize);
+
+	if (!frames) {
+		return BK_ALLOCATION_ERROR;
+	}
 
 	while (BKTimeIsLess(ctx->currentTime, endTime)) {
 		BKTime deltaTime = BKTimeSub(endTime, ctx->currentTime);
-		BKFUInt20 period;
+		// end units until buffer is filled
+		BKFUInt64 period = (BKFUInt64)(maxChunkSize - BKContextSize(ctx)) << BK_FINT20_SHIFT;
 
-		if (BKTimeIsLessFUInt20(deltaTime, BK_INT_MAX / 3)) {
-			period = BKTimeGetFUInt20(deltaTime);
-		}
-		else {
-			period = BK_INT_MAX / 3;
+		if (BKTimeIsLessFUInt64(deltaTime, period)) {
+			period = BKTimeGetFUInt64(deltaTime);
 		}
 
-		BKContextEnd(ctx, period);
+		result = BKContextEnd(ctx, period);
+
+		if (result < 0) {
+			break;
+		}
 
 		// write frames if buffer filled or end time is reached
-		if (BKBufferSize(&ctx->channels[0]) >= BK_MAX_GENERATE_SAMPLES || BKTimeIsGreaterEqual(ctx->currentTime, endTime)) {
+		if (BKBufferSize(&ctx->channels[0]) >= maxChunkSize || BKTimeIsGreaterEqual(ctx->currentTime, endTime)) {
 			BKInt size;
 
-			size = BKContextRead(ctx, frames, BK_MAX_GENERATE_SAMPLES);
+			size = BKContextRead(ctx, frames, maxChunkSize);
 			numFrames += size;
 
 			if (write(frames, size, info) != 0) {
-				return BK_INVALID_RETURN_VALUE;
+				result = BK_INVALID_RETURN_VALUE;
+				break;
 			}
 		}
 	}
 
-	return numFrames;
+	BKMemFree(frames);
+
+	return result < 0 ? result : numFrames;
 }
 
 /**
- * Get next clock tick period of all clocks
- * Increment clock times by that period and set new time if some clock ticks
+ * Check if clock `a` ticks before clock `b`
+ * Clocks ticking at the same time are ordered by their position in the clock list
  */
-static BKFUInt20 BKClocksAdvance(BKContext* ctx, BKClock* clocks, BKInt* error) {
-	BKTime nextTime;
+BK_INLINE BKInt BKClockIsBefore(BKClock const* a, BKClock const* b) {
+	if (BKTimeIsEqual(a->nextTime, b->nextTime)) {
+		return a->order < b->order;
+	}
 
-	do {
-		nextTime = BK_TIME_MAX;
-		ctx->flags &= ~BK_CONTEXT_FLAG_CLOCK_RESET; // clear clock reset flag
+	return BKTimeIsLess(a->nextTime, b->nextTime);
+}
 
-		for (BKClock* clock = clocks; clock; clock = clock->nextClock) {
-			BKClockTick(clock);
+/**
+ * Move clock at heap position `index` to its position
+ */
+static void BKContextSiftClock(BKContext* ctx, BKUInt index) {
+	BKClock** heap = ctx->clockHeap;
+	BKClock* clock = heap[index];
 
-			// get next time to tick
-			if (BKTimeIsLess(clock->nextTime, nextTime)) {
-				nextTime = clock->nextTime;
-			}
-		}
-	}
-	while (ctx->flags & BK_CONTEXT_FLAG_CLOCK_RESET);
+	// move up
+	while (index > 0) {
+		BKUInt parent = (index - 1) >> 1;
 
-	BKTime deltaTime = BKTimeSub(nextTime, ctx->currentTime);
-	BKFUInt20 period;
+		if (!BKClockIsBefore(clock, heap[parent])) {
+			break;
+		}
 
-	if (BKTimeIsLessFUInt20(deltaTime, BK_INT_MAX / 3)) {
-		period = BKTimeGetFUInt20(deltaTime);
-	}
-	else {
-		period = BK_INT_MAX / 3;
+		heap[index] = heap[parent];
+		heap[index]->heapIndex = index;
+		index = parent;
 	}
 
-	// advance
-	for (BKClock* clock = clocks; clock; clock = clock->nextClock) {
-		BKClockAdvance(clock, period);
-	}
+	// move down
+	for (;;) {
+		BKUInt child = (index << 1) + 1;
 
-	ctx->currentTime = BKTimeAddFUInt20(ctx->currentTime, period);
+		if (child >= ctx->numClocks) {
+			break;
+		}
 
-	return period;
-}
+		if (child + 1 < ctx->numClocks && BKClockIsBefore(heap[child + 1], heap[child])) {
+			child++;
+		}
 
-BKInt BKContextRun(BKContext* ctx, BKFUInt20 endTime) {
-	if (ctx->firstClock) {
-		BKFUInt20 time;
+		if (!BKClockIsBefore(heap[child], clock)) {
+			break;
+		}
 
-		for (time = ctx->deltaTime; time < endTime;) {
-			BKInt result = 0;
-			BKFUInt20 clockDelta = BKClocksAdvance(ctx, ctx->firstClock, &result);
+		heap[index] = heap[child];
+		heap[index]->heapIndex = index;
+		index = child;
+	}
 
-			if (result < 0) {
-				return result;
-			}
+	heap[index] = clock;
+	clock->heapIndex = index;
+}
 
-			// set new end time
-			time += clockDelta;
+BKInt BKContextAddClock(BKContext* ctx, BKClock* clock) {
+	if (ctx->numClocks >= ctx->clockHeapCapacity) {
+		BKUInt capacity = BKMax(8, ctx->clockHeapCapacity * 2);
+		BKClock** heap = BKMemRealloc(ctx->clockHeap, capacity * sizeof(BKClock*));
 
-			// run units
-			for (BKUnit* unit = ctx->firstUnit; unit; unit = unit->nextUnit) {
-				unit->run(unit, time);
-			}
+		if (heap == NULL) {
+			return BK_ALLOCATION_ERROR;
 		}
 
-		ctx->deltaTime = time;
-	}
-	else {
-		// run units
-		for (BKUnit* unit = ctx->firstUnit; unit; unit = unit->nextUnit) {
-			unit->run(unit, endTime);
-		}
+		ctx->clockHeap = heap;
+		ctx->clockHeapCapacity = capacity;
 	}
 
-	return endTime;
+	clock->heapIndex = ctx->numClocks++;
+	ctx->clockHeap[clock->heapIndex] = clock;
+	BKContextSiftClock(ctx, clock->heapIndex);
+
+	return 0;
 }
 
-BKInt BKContextEnd(BKContext* ctx, BKFUInt20 endTime) {
-	BKInt result = BKContextRun(ctx, endTime);
+void BKContextRemoveClock(BKContext* ctx, BKClock* clock) {
+	BKUInt index = clock->heapIndex;
 
-	if (result < 0) {
-		return result;
+	if (index >= ctx->numClocks || ctx->clockHeap[index] != clock) {
+		return;
 	}
 
-	// end clock time
-	ctx->deltaTime -= endTime;
+	BKClock* last = ctx->clockHeap[--ctx->numClocks];
 
-	// end units
-	for (BKUnit* unit = ctx->firstUnit; unit; unit = unit->nextUnit) {
-		unit->end(unit, endTime);
+	if (last != clock) {
+		ctx->clockHeap[index] = last;
+		BKContextSiftClock(ctx, index);
 	}
+}
 
-	// shift channel buffers
-	for (BKInt i = 0; i < ctx->numChannels; i++) {
+void BKContextUpdateClock(BKContext* ctx, BKClock* clock) {
+	BKUInt index = clock->heapIndex;
+
+	if (index < ctx->numClocks && ctx->clockHeap[index] == clock) {
+		BKContextSiftClock(ctx, index);
+	}
+}
+
+/**
+ * Apply due commands
+ * Returns the time of the next pending command
+ */
+static BKTime BKContextApplyCommands(BKContext* ctx) {
+	BKCommand const* command;
+
+	while ((command = BKCommandQueuePeek(ctx->commands))) {
+		if (BKTimeIsGreater(command->time, ctx->currentTime)) {
+			return command->time;
+		}
+
+		switch (command->type) {
+			case BK_COMMAND_SET_ATTR: {
+				BKSetAttr(command->object, command->attr, command->value);
+				break;
+			}
+			case BK_COMMAND_SET_PTR: {
+				BKSetPtr(command->object, command->attr, command->ptr, command->size);
+				break;
+			}
+		}
+
+		BKCommandQueuePop(ctx->commands);
+	}
+
+	return BK_TIME_MAX;
+}
+
+BK_INLINE BKInt BKContextEventIsBefore(BKContextEvent const* a, BKContextEvent const* b) {
+	if (BKTimeIsEqual(a->time, b->time)) {
+		return (BKInt)(a->order - b->order) < 0;
+	}
+
+	return BKTimeIsLess(a->time, b->time);
+}
+
+/**
+ * Insert event into heap
+ * Capacity has to be reserved
+ */
+static void BKContextPushEvent(BKContext* ctx, BKTime time, BKCallback* callback) {
+	BKContextEvent event = {
+		.time = time,
+		.order = ctx->eventOrder++,
+		.callback = *callback,
+	};
+
+	BKContextEvent* events = ctx->events;
+	BKUInt index = ctx->numEvents++;
+
+	// move up
+	while (index > 0) {
+		BKUInt parent = (index - 1) >> 1;
+
+		if (!BKContextEventIsBefore(&event, &events[parent])) {
+			break;
+		}
+
+		events[index] = events[parent];
+		index = parent;
+	}
+
+	events[index] = event;
+}
+
+BKInt BKContextScheduleEvent(BKContext* ctx, BKTime time, BKCallback* callback) {
+	// keep slots reserved for called events
+	if (ctx->numEvents + ctx->numReservedEvents >= ctx->eventsCapacity) {
+		BKUInt capacity = BKMax(16, ctx->eventsCapacity * 2);
+		BKContextEvent* events = BKMemRealloc(ctx->events, capacity * sizeof(BKContextEvent));
+
+		if (events == NULL) {
+			return BK_ALLOCATION_ERROR;
+		}
+
+		ctx->events = events;
+		ctx->eventsCapacity = capacity;
+	}
+
+	BKContextPushEvent(ctx, time, callback);
+
+	return 0;
+}
+
+/**
+ * Remove first event
+ */
+static void BKContextPopEvent(BKContext* ctx) {
+	BKContextEvent* events = ctx->events;
+	BKContextEvent last = events[--ctx->numEvents];
+	BKUInt index = 0;
+
+	// move down
+	for (;;) {
+		BKUInt child = (index << 1) + 1;
+
+		if (child >= ctx->numEvents) {
+			break;
+		}
+
+		if (child + 1 < ctx->numEvents && BKContextEventIsBefore(&events[child + 1], &events[child])) {
+			child++;
+		}
+
+		if (!BKContextEventIsBefore(&events[child], &last)) {
+			break;
+		}
+
+		events[index] = events[child];
+		index = child;
+	}
+
+	events[index] = last;
+}
+
+/**
+ * Call due events
+ * Returns the time of the next event
+ */
+static BKTime BKContextCallEvents(BKContext* ctx) {
+	BKCallbackInfo info;
+
+	while (ctx->numEvents) {
+		BKContextEvent event = ctx->events[0];
+
+		if (BKTimeIsGreater(event.time, ctx->currentTime)) {
+			return event.time;
+		}
+
+		// remove before calling as callback may schedule events
+		// the slot stays reserved so a repeating event cannot fail to be rescheduled
+		BKContextPopEvent(ctx);
+		ctx->numReservedEvents++;
+
+		memset(&info, 0, sizeof(BKCallbackInfo));
+		info.object = ctx;
+		info.event = BK_EVENT_SCHEDULED;
+		info.nextTime = event.time;
+
+		if (event.callback.func) {
+			event.callback.func(&info, event.callback.userInfo);
+		}
+
+		ctx->numReservedEvents--;
+
+		// repeat event
+		if (BKTimeIsGreater(info.nextTime, event.time)) {
+			BKContextPushEvent(ctx, info.nextTime, &event.callback);
+		}
+	}
+
+	return BK_TIME_MAX;
+}
+
+/**
+ * Apply due commands, call due events, tick due clocks and get period until next event
+ * Period is limited to `maxPeriod`
+ */
+static BKFUInt64 BKClocksAdvance(BKContext* ctx, BKFUInt64 maxPeriod) {
+	BKTime nextTime;
+	BKTime eventTime;
+
+	do {
+		nextTime = BKContextApplyCommands(ctx);
+		eventTime = BKContextCallEvents(ctx);
+
+		if (BKTimeIsLess(eventTime, nextTime)) {
+			nextTime = eventTime;
+		}
+
+		// clocks reset or attached by callbacks tick immediately
+		while (ctx->numClocks) {
+			BKClock* clock = ctx->clockHeap[0];
+
+			if (BKTimeIsGreater(clock->nextTime, ctx->currentTime)) {
+				if (BKTimeIsLess(clock->nextTime, nextTime)) {
+					nextTime = clock->nextTime;
+				}
+
+				break;
+			}
+
+			BKClockTick(clock);
+
+#if BK_USE_PROFILING
+			ctx->profile.numClockTicks++;
+#endif
+		}
+	}
+	// clock callbacks may have scheduled due events
+	while (ctx->numEvents && !BKTimeIsGreater(ctx->events[0].time, ctx->currentTime));
+
+	// clock callbacks may have scheduled events
+	if (ctx->numEvents && BKTimeIsLess(ctx->events[0].time, nextTime)) {
+		nextTime = ctx->events[0].time;
+	}
+
+	BKTime deltaTime = BKTimeSub(nextTime, ctx->currentTime);
+	BKFUInt64 period;
+
+	if (BKTimeIsLessFUInt64(deltaTime, maxPeriod)) {
+		period = BKTimeGetFUInt64(deltaTime);
+	}
+	else {
+		period = maxPeriod;
+	}
+
+	ctx->currentTime = BKTimeAddFUInt64(ctx->currentTime, period);
+
+	return period;
+}
+
+BKInt BKContextRun(BKContext* ctx, BKFUInt64 endTime) {
+	BKInt result = 0;
+	BKFUInt64 time;
+
+	if (ctx->workers) {
+		result = BKContextBeginWorkers(ctx);
+
+		if (result < 0) {
+			return result;
+		}
+	}
+
+	for (time = ctx->deltaTime; time < endTime;) {
+		BKFUInt64 maxPeriod = endTime - time;
+
+		// units may run ahead of end time until next clock tick
+		if (ctx->firstClock) {
+			maxPeriod += BK_MAX_RUN_PERIOD;
+		}
+
+		// set new end time
+		time += BKClocksAdvance(ctx, maxPeriod);
+
+		// run units
+#if BK_USE_PROFILING
+		uint64_t start = BKProfileTime();
+
+		result = BKContextRunUnits(ctx, time);
+
+		ctx->profile.numBlocks++;
+		ctx->profile.runTime += BKProfileTime() - start;
+#else
+		result = BKContextRunUnits(ctx, time);
+#endif
+
+		if (result < 0) {
+			break;
+		}
+
+		// advance buffer capacity as sleeping units would have
+		if (ctx->firstUnit && !ctx->firstActiveUnit) {
+			for (BKInt i = 0; i < ctx->numChannels; i++) {
+				BKBufferEnd(&ctx->channels[i], time);
+			}
+		}
+
+		// woken units continue at this time
+		ctx->deltaTime = time;
+	}
+
+	if (ctx->workers) {
+		BKContextEndWorkers(ctx);
+	}
+
+	if (result < 0) {
+		return result;
+	}
+
+	return (BKInt)BKMin(endTime, BK_INT_MAX);
+}
+
+BKInt BKContextEnd(BKContext* ctx, BKFUInt64 endTime) {
+	BKInt result = BKContextRun(ctx, endTime);
+
+	if (result < 0) {
+		return result;
+	}
+
+	// end clock time
+	ctx->deltaTime -= endTime;
+
+	// end units; sleeping units are shifted when woken up
+	for (BKUnit* unit = ctx->firstActiveUnit; unit; unit = unit->nextActiveUnit) {
+		unit->end(unit, endTime);
+	}
+
+	// shift channel buffers
+	for (BKInt i = 0; i < ctx->numChannels; i++) {
 		BKBuffer* channel = &ctx->channels[i];
 		BKBufferShift(channel, endTime);
 	}
 
-	return endTime;
+	return result;
+}
+
+BKInt BKContextSkip(BKContext* ctx, BKTime duration) {
+	BKFUInt64 endTime = BKTimeGetFUInt64(duration);
+	BKUnit* nextUnit;
+
+	// same as `BKContextRun` but units don't run ahead of end time
+	for (BKFUInt64 time = ctx->deltaTime; time < endTime;) {
+		time += BKClocksAdvance(ctx, endTime - time);
+
+		for (BKUnit* unit = ctx->firstActiveUnit; unit; unit = nextUnit) {
+			nextUnit = unit->nextActiveUnit;
+			unit->skip(unit, time);
+
+			if (unit->idle(unit)) {
+				BKContextSleepUnit(ctx, unit);
+			}
+		}
+
+		ctx->deltaTime = time;
+	}
+
+	ctx->deltaTime -= endTime;
+
+	for (BKUnit* unit = ctx->firstActiveUnit; unit; unit = unit->nextActiveUnit) {
+		unit->end(unit, endTime);
+	}
+
+	// units continue from silence
+	for (BKUnit* unit = ctx->firstUnit; unit; unit = unit->nextUnit) {
+		for (BKInt i = 0; i < BK_MAX_CHANNELS; i++) {
+			unit->lastPulse[i] = 0;
+		}
+	}
+
+	for (BKInt i = 0; i < ctx->numChannels; i++) {
+		BKBufferClear(&ctx->channels[i]);
+	}
+
+	return 0;
 }
 
 BKInt BKContextSize(BKContext const* ctx) {
@@ -417,19 +1204,51 @@ BKInt BKContextSize(BKContext const* ctx) {
 }
 
 BKInt BKContextRead(BKContext* ctx, BKFrame outFrames[], BKUInt size) {
-	// read channels
-	for (BKInt i = 0; i < ctx->numChannels; i++) {
-		BKBuffer* channel = &ctx->channels[i];
-		// interlace into `outFrames`
-		size = BKBufferRead(channel, &outFrames[i], size, ctx->numChannels);
-	}
+	// read and interlace all channels into `outFrames`
+	return BKContextReadFormat(ctx, outFrames, 0, size, BK_CONTEXT_FORMAT_INT16);
+}
+
+BKInt BKContextReadFloat(BKContext* ctx, float outFrames[], BKUInt size) {
+	return BKContextReadFormat(ctx, outFrames, 0, size, BK_CONTEXT_FORMAT_FLOAT);
+}
+
+BKInt BKContextReadPlanar(BKContext* ctx, BKFrame* outFrames[], BKUInt size) {
+	return BKContextReadFormat(ctx, outFrames, 0, size, BK_CONTEXT_FORMAT_INT16_PLANAR);
+}
 
-	return size;
+BKInt BKContextReadFloatPlanar(BKContext* ctx, float* outFrames[], BKUInt size) {
+	return BKContextReadFormat(ctx, outFrames, 0, size, BK_CONTEXT_FORMAT_FLOAT_PLANAR);
+}
+
+BKInt BKContextQueueAttr(BKContext* ctx, BKTime time, void* object, BKEnum attr, BKInt value) {
+	BKCommand command = {
+		.time = time,
+		.type = BK_COMMAND_SET_ATTR,
+		.object = object,
+		.attr = attr,
+		.value = value,
+	};
+
+	return BKCommandQueuePush(ctx->commands, &command);
+}
+
+BKInt BKContextQueuePtr(BKContext* ctx, BKTime time, void* object, BKEnum attr, void* ptr, BKSize size) {
+	BKCommand command = {
+		.time = time,
+		.type = BK_COMMAND_SET_PTR,
+		.object = object,
+		.attr = attr,
+		.ptr = ptr,
+		.size = size,
+	};
+
+	return BKCommandQueuePush(ctx->commands, &command);
 }
 
 void BKContextReset(BKContext* ctx) {
 	ctx->deltaTime = 0;
 	ctx->currentTime = BK_TIME_ZERO;
+	ctx->numEvents = 0;
 
 	for (BKUnit* unit = ctx->firstUnit; unit; unit = unit->nextUnit) {
 		if (unit->reset) {
@@ -447,6 +1266,401 @@ void BKContextReset(BKContext* ctx) {
 	}
 }
 
+#define BK_SNAPSHOT_MAGIC 0x424B5331 // "BKS1"
+
+/**
+ * Snapshot header followed by clock, divider, channel and unit states
+ */
+typedef struct {
+	BKUInt magic;
+	BKUInt size;
+	BKUInt numChannels;
+	BKUInt sampleRate;
+	BKUInt numClocks;
+	BKUInt numDividers;
+	BKUInt numUnits;
+	BKFUInt64 deltaTime;
+	BKTime currentTime;
+} BKContextSnapshotHeader;
+
+typedef struct {
+	BKTime period;
+	BKTime startTime;
+	BKTime nextTime;
+	BKUInt counter;
+	BKUInt flags;
+} BKContextClockState;
+
+typedef struct {
+	BKInt divider;
+	BKInt counter;
+} BKContextDividerState;
+
+/**
+ * Followed by `numFrames` frames starting at the ring buffer head
+ */
+typedef struct {
+	BKUInt offset;
+	BKFUInt20 time;
+	BKUInt capacity;
+	BKInt accum;
+	BKUInt numFrames;
+} BKContextChannelState;
+
+/**
+ * Followed by `size` bytes written by `save` of the unit
+ */
+typedef struct {
+	BKUInt size;
+	BKUInt active;
+} BKContextUnitState;
+
+/**
+ * Copy `size` bytes to `data` at `offset` if `data` is not NULL
+ * Snapshots may not be aligned
+ */
+static void BKContextSnapshotPut(char* data, BKSize* offset, void const* value, BKSize size) {
+	if (data) {
+		memcpy(&data[*offset], value, size);
+	}
+
+	*offset += size;
+}
+
+/**
+ * Copy `size` bytes from `data` at `offset` if available
+ */
+static BKInt BKContextSnapshotGet(char const* data, BKSize dataSize, BKSize* offset, void* value, BKSize size) {
+	if (*offset + size > dataSize) {
+		return BK_INVALID_VALUE;
+	}
+
+	memcpy(value, &data[*offset], size);
+	*offset += size;
+
+	return 0;
+}
+
+static BKUInt BKContextCountDividers(BKDividerGroup const* group) {
+	BKUInt numDividers = 0;
+
+	for (BKDivider const* divider = group->firstDivider; divider; divider = divider->nextDivider) {
+		numDividers++;
+	}
+
+	return numDividers;
+}
+
+/**
+ * Count attached clocks, dividers and units
+ */
+static void BKContextCountObjects(BKContext const* ctx, BKContextSnapshotHeader* header) {
+	header->numClocks = 0;
+	header->numDividers = 0;
+	header->numUnits = 0;
+
+	for (BKClock const* clock = ctx->firstClock; clock; clock = clock->nextClock) {
+		header->numClocks++;
+		header->numDividers += BKContextCountDividers(&clock->dividers);
+	}
+
+	header->numDividers += BKContextCountDividers(&ctx->beatDividers);
+	header->numDividers += BKContextCountDividers(&ctx->effectDividers);
+
+	for (BKUnit const* unit = ctx->firstUnit; unit; unit = unit->nextUnit) {
+		header->numUnits++;
+	}
+}
+
+static void BKContextSaveDividers(BKDividerGroup const* group, char* data, BKSize* offset) {
+	for (BKDivider const* divider = group->firstDivider; divider; divider = divider->nextDivider) {
+		BKContextDividerState state = {
+			.divider = divider->divider,
+			.counter = divider->counter,
+		};
+
+		BKContextSnapshotPut(data, offset, &state, sizeof(state));
+	}
+}
+
+static BKInt BKContextRestoreDividers(BKDividerGroup* group, char const* data, BKSize size, BKSize* offset, BKInt check) {
+	BKContextDividerState state;
+
+	for (BKDivider* divider = group->firstDivider; divider; divider = divider->nextDivider) {
+		if (BKContextSnapshotGet(data, size, offset, &state, sizeof(state)) < 0) {
+			return BK_INVALID_VALUE;
+		}
+
+		if (!check) {
+			divider->divider = state.divider;
+			divider->counter = state.counter;
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * Get number of frames from ring buffer head to the last non-zero frame
+ * Frames after are zero as read frames are cleared
+ */
+static BKUInt BKContextChannelNumFrames(BKBuffer const* buf) {
+	BKUInt numFrames = buf->mask + 1;
+
+	while (numFrames > 0 && buf->frames[(buf->head + numFrames - 1) & buf->mask] == 0) {
+		numFrames--;
+	}
+
+	return numFrames;
+}
+
+/**
+ * Write snapshot into `data` or only get its size if `data` is NULL
+ */
+static BKSize BKContextSnapshotWrite(BKContext const* ctx, char* data) {
+	BKContextSnapshotHeader header;
+	BKSize offset = sizeof(header);
+	BKSize headerOffset = 0;
+
+	memset(&header, 0, sizeof(header));
+	BKContextCountObjects(ctx, &header);
+
+	header.magic = BK_SNAPSHOT_MAGIC;
+	header.numChannels = ctx->numChannels;
+	header.sampleRate = ctx->sampleRate;
+	header.deltaTime = ctx->deltaTime;
+	header.currentTime = ctx->currentTime;
+
+	for (BKClock const* clock = ctx->firstClock; clock; clock = clock->nextClock) {
+		BKContextClockState state = {
+			.period = clock->period,
+			.startTime = clock->startTime,
+			.nextTime = clock->nextTime,
+			.counter = clock->counter,
+			.flags = clock->object.flags & BKObjectFlagUsableMask,
+		};
+
+		BKContextSnapshotPut(data, &offset, &state, sizeof(state));
+	}
+
+	for (BKClock const* clock = ctx->firstClock; clock; clock = clock->nextClock) {
+		BKContextSaveDividers(&clock->dividers, data, &offset);
+	}
+
+	BKContextSaveDividers(&ctx->beatDividers, data, &offset);
+	BKContextSaveDividers(&ctx->effectDividers, data, &offset);
+
+	for (BKInt i = 0; i < ctx->numChannels; i++) {
+		BKBuffer const* buf = &ctx->channels[i];
+		BKUInt numFrames = BKContextChannelNumFrames(buf);
+		BKUInt tailSize = BKMin(numFrames, buf->mask + 1 - buf->head);
+		BKContextChannelState state = {
+			.offset = buf->offset,
+			.time = buf->time,
+			.capacity = buf->capacity,
+			.accum = buf->accum,
+			.numFrames = numFrames,
+		};
+
+		BKContextSnapshotPut(data, &offset, &state, sizeof(state));
+		BKContextSnapshotPut(data, &offset, &buf->frames[buf->head], tailSize * sizeof(BKInt));
+		BKContextSnapshotPut(data, &offset, &buf->frames[0], (numFrames - tailSize) * sizeof(BKInt));
+	}
+
+	for (BKUnit const* unit = ctx->firstUnit; unit; unit = unit->nextUnit) {
+		BKContextUnitState state = {
+			.size = unit->save(unit, NULL),
+			.active = (unit->object.flags & BKUnitFlagActive) != 0,
+		};
+
+		BKContextSnapshotPut(data, &offset, &state, sizeof(state));
+
+		if (data) {
+			unit->save(unit, &data[offset]);
+		}
+
+		offset += state.size;
+	}
+
+	header.size = (BKUInt)offset;
+	BKContextSnapshotPut(data, &headerOffset, &header, sizeof(header));
+
+	return offset;
+}
+
+/**
+ * Set state from snapshot or only check if it can be set if `check` is not 0
+ */
+static BKInt BKContextRestoreState(BKContext* ctx, char const* data, BKSize size, BKInt check) {
+	BKContextSnapshotHeader header, current;
+	BKSize offset = 0;
+	BKInt res;
+
+	if (BKContextSnapshotGet(data, size, &offset, &header, sizeof(header)) < 0) {
+		return BK_INVALID_VALUE;
+	}
+
+	if (header.magic != BK_SNAPSHOT_MAGIC || header.size > size) {
+		return BK_INVALID_VALUE;
+	}
+
+	size = header.size;
+	BKContextCountObjects(ctx, &current);
+
+	if (header.numChannels != ctx->numChannels || header.sampleRate != ctx->sampleRate) {
+		return BK_INVALID_STATE;
+	}
+
+	if (header.numClocks != current.numClocks || header.numDividers != current.numDividers || header.numUnits != current.numUnits) {
+		return BK_INVALID_STATE;
+	}
+
+	if (!check) {
+		ctx->deltaTime = header.deltaTime;
+		ctx->currentTime = header.currentTime;
+	}
+
+	for (BKClock* clock = ctx->firstClock; clock; clock = clock->nextClock) {
+		BKContextClockState state;
+
+		if (BKContextSnapshotGet(data, size, &offset, &state, sizeof(state)) < 0) {
+			return BK_INVALID_VALUE;
+		}
+
+		if (!check) {
+			clock->period = state.period;
+			clock->startTime = state.startTime;
+			clock->nextTime = state.nextTime;
+			clock->counter = state.counter;
+			clock->object.flags = (clock->object.flags & BKObjectFlagMask) | state.flags;
+		}
+	}
+
+	for (BKClock* clock = ctx->firstClock; clock; clock = clock->nextClock) {
+		if ((res = BKContextRestoreDividers(&clock->dividers, data, size, &offset, check)) < 0) {
+			return res;
+		}
+	}
+
+	if ((res = BKContextRestoreDividers(&ctx->beatDividers, data, size, &offset, check)) < 0) {
+		return res;
+	}
+
+	if ((res = BKContextRestoreDividers(&ctx->effectDividers, data, size, &offset, check)) < 0) {
+		return res;
+	}
+
+	for (BKInt i = 0; i < ctx->numChannels; i++) {
+		BKBuffer* buf = &ctx->channels[i];
+		BKContextChannelState state;
+
+		if (BKContextSnapshotGet(data, size, &offset, &state, sizeof(state)) < 0) {
+			return BK_INVALID_VALUE;
+		}
+
+		// buffer capacity may have been reduced
+		if (state.numFrames > buf->mask + 1 || state.capacity > buf->maxCapacity || state.offset > state.capacity) {
+			return BK_INVALID_STATE;
+		}
+
+		if (!check) {
+			memset(buf->frames, 0, (buf->mask + 1) * sizeof(BKInt));
+			buf->head = 0;
+			buf->offset = state.offset;
+			buf->time = state.time;
+			buf->capacity = state.capacity;
+			buf->accum = state.accum;
+		}
+
+		BKSize framesSize = state.numFrames * sizeof(BKInt);
+
+		if (offset + framesSize > size) {
+			return BK_INVALID_VALUE;
+		}
+
+		if (!check) {
+			memcpy(buf->frames, &data[offset], framesSize);
+		}
+
+		offset += framesSize;
+	}
+
+	for (BKUnit* unit = ctx->firstUnit; unit; unit = unit->nextUnit) {
+		BKContextUnitState state;
+
+		if (BKContextSnapshotGet(data, size, &offset, &state, sizeof(state)) < 0) {
+			return BK_INVALID_VALUE;
+		}
+
+		if (state.size != unit->save(unit, NULL)) {
+			return BK_INVALID_STATE;
+		}
+
+		if (offset + state.size > size) {
+			return BK_INVALID_VALUE;
+		}
+
+		if (check) {
+			if ((res = unit->restore(unit, &data[offset], 1)) < 0) {
+				return res;
+			}
+		}
+		else {
+			unit->restore(unit, &data[offset], 0);
+
+			// waking sets the current time
+			BKFUInt64 time = unit->time;
+
+			BKContextSleepUnit(ctx, unit);
+
+			if (state.active) {
+				BKContextWakeUnit(ctx, unit);
+				unit->time = time;
+			}
+		}
+
+		offset += state.size;
+	}
+
+	if (!check) {
+		// rebuild scheduler as tick times have changed
+		ctx->numClocks = 0;
+
+		for (BKClock* clock = ctx->firstClock; clock; clock = clock->nextClock) {
+			clock->heapIndex = ctx->numClocks++;
+			ctx->clockHeap[clock->heapIndex] = clock;
+			BKContextSiftClock(ctx, clock->heapIndex);
+		}
+	}
+
+	return 0;
+}
+
+BKInt BKContextSnapshot(BKContext const* ctx, void* outData, BKSize size) {
+	BKSize snapshotSize = BKContextSnapshotWrite(ctx, NULL);
+
+	if (outData) {
+		if (size < snapshotSize) {
+			return BK_INVALID_VALUE;
+		}
+
+		BKContextSnapshotWrite(ctx, outData);
+	}
+
+	return (BKInt)snapshotSize;
+}
+
+BKInt BKContextRestore(BKContext* ctx, void const* data, BKSize size) {
+	// check all objects first to not change anything if failing
+	BKInt res = BKContextRestoreState(ctx, data, size, 1);
+
+	if (res < 0) {
+		return res;
+	}
+
+	return BKContextRestoreState(ctx, data, size, 0);
+}
+
 BKInt BKContextAttachDivider(BKContext* ctx, BKDivider* divider, BKEnum type) {
 	BKDividerGroup* group = NULL;
 
@@ -26,13 +26,16 @@
 
 #include "BKBuffer.h"
 #include "BKClock.h"
+#include "BKCommandQueue.h"
 #include "BKObject.h"
+#include "BKWorkerPool.h"
 
 /**
  * The context buffers the samples generated by units
  */
 
 typedef struct BKUnit BKUnit;
+typedef struct BKContextEvent BKContextEvent;
 
 typedef BKEnum (*BKGenerateCallback)(BKTime* nextTime, void* info);
 
@@ -42,10 +45,30 @@ enum {
 };
 
 enum {
-	BK_CONTEXT_FLAG_CLOCK_RESET = 1 << 0,
+	BK_CONTEXT_FLAG_CLOCK_RESET = 1 << 0,	  // unused; clocks are scheduled by tick time
+	BK_CONTEXT_FLAG_WORKERS_RUNNING = 1 << 1, // units are rendered on workers; waking units is deferred
 	BK_CONTEXT_FLAG_COPY_MASK = 0,
 };
 
+/**
+ * Render counters of context
+ * Only updated when compiled with `BK_USE_PROFILING`
+ */
+typedef struct {
+	uint64_t numBlocks;		// run steps between clock ticks and events
+	uint64_t numClockTicks; // ticks of all clocks
+	uint64_t runTime;		// nanoseconds spent running units
+	uint64_t numReads;		// buffer reads
+	uint64_t numReadFrames; // frames read
+	uint64_t readTime;		// nanoseconds spent reading buffers
+} BKContextProfile;
+
+struct BKContextEvent {
+	BKTime time;
+	BKUInt order; // keeps events at the same time in scheduled order
+	BKCallback callback;
+};
+
 struct BKContext {
 	BKObject object;
 	BKUInt flags;
@@ -55,7 +78,7 @@ struct BKContext {
 	BKUInt sampleRate;
 
 	// run time
-	BKFUInt20 deltaTime;
+	BKFUInt64 deltaTime;
 	BKTime currentTime;
 
 	// master clocks
@@ -68,13 +91,44 @@ struct BKContext {
 	// linked clocks
 	BKClock* firstClock;
 	BKClock* lastClock;
+	BKUInt clockOrder; // order of last appended clock
+
+	// clocks ordered by next tick time
+	BKClock** clockHeap;
+	BKUInt numClocks;
+	BKUInt clockHeapCapacity;
 
 	// linked units
 	BKUnit* firstUnit;
 	BKUnit* lastUnit;
 
+	// units which are not idle
+	BKUnit* firstActiveUnit;
+	BKUnit* lastActiveUnit;
+
 	// channels
 	BKBuffer* channels;
+
+	// commands from control thread
+	BKCommandQueue* commands;
+
+	// scheduled events ordered by time
+	BKContextEvent* events;
+	BKUInt numEvents;
+	BKUInt eventsCapacity;
+	BKUInt numReservedEvents; // slots of events being called
+	BKUInt eventOrder;
+
+	// workers
+	BKWorkerPool* workers;
+	BKBuffer* workerChannels; // channels of workers 1 to n
+	BKUnit** workerUnits;	  // active units; each worker renders a contiguous range
+	BKUInt numWorkerUnits;
+	BKUInt workerUnitsCapacity;
+	BKFUInt64 workerEndTime;
+
+	// only updated with `BK_USE_PROFILING`; always present to keep the struct layout
+	BKContextProfile profile;
 };
 
 /**
@@ -103,10 +157,30 @@ extern BKInt BKContextAlloc(BKContext** outCtx, BKUInt numChannels, BKUInt sampl
  *   Set divider value for effect step for all attached tracks
  * BK_INSTRUMENT_DIVIDER
  *   Set divider value for instrument step for all attached tracks
+ * BK_CONTEXT_BUFFER_CAPACITY
+ *   Maximum number of frames buffered per channel
+ *   Larger values let `BKContextGenerate` render in larger blocks
+ *   Value must be in range [BK_DEFAULT_BUFFER_CAPACITY, BK_MAX_BUFFER_CAPACITY]
+ *   The capacity is unchanged if the frames of any channel could not be allocated
+ * BK_NUM_THREADS
+ *   Number of threads rendering units (default 1)
+ *   Units are distributed over the threads which render into separate buffers
+ *   summed after each run; the output is the same for any number of threads
+ *   Clock callbacks are called on the calling thread, sample callbacks may be
+ *   called on any thread while other units are rendered; they must only change
+ *   their own unit and must not attach or detach units
+ *   Units woken by sample callbacks are rendered after all threads have finished
+ *   Value must be in range [1, BK_MAX_WORKERS]
+ * BK_PROFILE
+ *   Reset render counters of context; value is ignored
+ *   Only available when compiled with `BK_USE_PROFILING`
  *
  * Errors:
  * BK_INVALID_ATTRIBUTE if attribute is unkown
  * BK_INVALID_VALUE if value is invalid for this attribute
+ * BK_INVALID_STATE if channels contain more frames than the new capacity
+ *   or if threads are not supported
+ * BK_ALLOCATION_ERROR if buffers could not be allocated
  */
 extern BKInt BKContextSetAttr(BKContext* ctx, BKEnum attr, BKInt value) BK_DEPRECATED_FUNC("Use 'BKSetAttr' instead");
 
@@ -115,6 +189,8 @@ extern BKInt BKContextSetAttr(BKContext* ctx, BKEnum attr, BKInt value) BK_DEPRE
  *
  * BK_SAMPLE_RATE
  * BK_NUM_CHANNELS
+ * BK_CONTEXT_BUFFER_CAPACITY
+ * BK_NUM_THREADS
  *
  * Errors:
  * BK_INVALID_ATTRIBUTE if attribute is unkown
@@ -127,6 +203,11 @@ extern BKInt BKContextGetAttr(BKContext const* ctx, BKEnum attr, BKInt* outValue
  * BK_CLOCK_PERIOD
  *   Clock period of master clock
  *   `BKClockPeriod`
+ * BK_PULSE_KERNEL
+ *   Pulse kernel used by all channels
+ *   `BKBufferPulse` from `BKBufferPulseKernels` or `BKBufferPulseInit`
+ *   The kernel is not copied and must outlive the context
+ *   Default kernel is set if NULL
  *
  * Errors:
  * BK_INVALID_ATTRIBUTE if attribute is unkown
@@ -142,6 +223,12 @@ extern BKInt BKContextSetPtr(BKContext* ctx, BKEnum attr, void* ptr) BK_DEPRECAT
  * BK_TIME
  *   Get the current absolute time
  *   ptrRef = `BKTime`
+ * BK_PULSE_KERNEL
+ *   ptrRef = `BKBufferPulse const*`
+ * BK_PROFILE
+ *   Get render counters of context
+ *   Only available when compiled with `BK_USE_PROFILING`
+ *   ptrRef = `BKContextProfile`
  *
  * Errors:
  * BK_INVALID_ATTRIBUTE if attribute is unkown
@@ -157,25 +244,61 @@ extern BKInt BKContextGetPtr(BKContext const* ctx, BKEnum attr, void* outPtr) BK
  */
 extern BKInt BKContextGenerate(BKContext* ctx, BKFrame outFrames[], BKUInt size);
 
+/**
+ * Generate float frames
+ * Channels are interlaced in the form LRLRLR
+ * Frames are not clamped and may exceed the range [-1.0, +1.0]
+ */
+extern BKInt BKContextGenerateFloat(BKContext* ctx, float outFrames[], BKUInt size);
+
+/**
+ * Generate frames into separate channel buffers
+ * `outFrames` contains a buffer for each channel with space for `size` frames
+ */
+extern BKInt BKContextGeneratePlanar(BKContext* ctx, BKFrame* outFrames[], BKUInt size);
+
+/**
+ * Generate float frames into separate channel buffers
+ */
+extern BKInt BKContextGenerateFloatPlanar(BKContext* ctx, float* outFrames[], BKUInt size);
+
 /**
  * Generate frames to specified time
  * `write` is called every time new frames are available from the buffer
+ * with at most BK_CONTEXT_BUFFER_CAPACITY frames
  * If `write` doesn't return 0 BK_INVALID_RETURN_VALUE is return
  *
  * Errors:
  * BK_INVALID_RETURN_VALUE if `write` doesn't return 0
+ * BK_ALLOCATION_ERROR if frame buffer could not be allocated
  */
 extern BKInt BKContextGenerateToTime(BKContext* ctx, BKTime endTime, BKInt (*write)(BKFrame inFrames[], BKUInt size, void* info), void* info);
 
 /**
  * Run context to specific time
+ * Time is measured from the beginning of the buffered frames
+ * and can span as many frames as the buffer capacity
+ *
+ * `endTime` was a `BKFUInt20` before; `BKFUInt20` values are still accepted
+ * Returns `endTime` or BK_INT_MAX if it is larger
+ */
+extern BKInt BKContextRun(BKContext* ctx, BKFUInt64 endTime);
+
+/**
+ * End all units and advance buffers to `endTime`
+ * Frames before `endTime` can be read afterwards
+ *
+ * Returns `endTime` or BK_INT_MAX if it is larger
  */
-extern BKInt BKContextRun(BKContext* ctx, BKFUInt20 endTime);
+extern BKInt BKContextEnd(BKContext* ctx, BKFUInt64 endTime);
 
 /**
- * End all units
+ * Advance context by `duration` without rendering frames
+ * Commands, events, clocks, dividers and tracks are updated and unit phases
+ * are advanced exactly as when generating frames
+ * Buffered frames are discarded and units continue from silence
  */
-extern BKInt BKContextEnd(BKContext* ctx, BKFUInt20 endTime);
+extern BKInt BKContextSkip(BKContext* ctx, BKTime duration);
 
 /**
  * Get maximum readable frames
@@ -191,10 +314,92 @@ extern BKInt BKContextSize(BKContext const* ctx);
 extern BKInt BKContextRead(BKContext* ctx, BKFrame outFrames[], BKUInt size);
 
 /**
- * Reset all units, buffers and clocks
+ * Read float frames from channels
+ * Channels are interlaced in the form LRLRLR
+ * Frames are not clamped and may exceed the range [-1.0, +1.0]
+ */
+extern BKInt BKContextReadFloat(BKContext* ctx, float outFrames[], BKUInt size);
+
+/**
+ * Read frames into separate channel buffers
+ * `outFrames` contains a buffer for each channel with space for `size` frames
+ */
+extern BKInt BKContextReadPlanar(BKContext* ctx, BKFrame* outFrames[], BKUInt size);
+
+/**
+ * Read float frames into separate channel buffers
+ */
+extern BKInt BKContextReadFloatPlanar(BKContext* ctx, float* outFrames[], BKUInt size);
+
+/**
+ * Queue attribute change of `object` at absolute time `time`
+ * Can be called from a single control thread without locking while another thread
+ * is generating frames; the attribute is set with `BKSetAttr` when the context
+ * reaches `time` or at the next clock step if `time` has already passed
+ * Commands are applied in the order they are queued
+ *
+ * Errors:
+ * BK_INVALID_STATE if the queue is full
+ */
+extern BKInt BKContextQueueAttr(BKContext* ctx, BKTime time, void* object, BKEnum attr, BKInt value);
+
+/**
+ * Queue pointer change of `object` at absolute time `time`
+ * Same as `BKContextQueueAttr` but sets `ptr` with `BKSetPtr`
+ * `ptr` is not copied and must be valid until the command is applied
+ *
+ * Errors:
+ * BK_INVALID_STATE if the queue is full
+ */
+extern BKInt BKContextQueuePtr(BKContext* ctx, BKTime time, void* object, BKEnum attr, void* ptr, BKSize size);
+
+/**
+ * Schedule `callback` to be called at absolute time `time`
+ * Units are run exactly up to `time` before the callback is called
+ * Events at the same time are called in the order they were scheduled
+ * and before clocks ticking at the same time
+ * `nextTime` of the callback info contains the event time; setting it to
+ * a later time schedules the event again
+ * Events are removed by `BKContextReset`
+ *
+ * Errors:
+ * BK_ALLOCATION_ERROR if memory could not be allocated
+ */
+extern BKInt BKContextScheduleEvent(BKContext* ctx, BKTime time, BKCallback* callback);
+
+/**
+ * Reset all units, buffers, clocks and scheduled events
  */
 extern void BKContextReset(BKContext* ctx);
 
+/**
+ * Write state of context and all attached clocks, dividers, units and tracks
+ * together with buffered frames into `outData`
+ * The snapshot contains no addresses of itself and can be copied anywhere
+ * If `outData` is NULL only the size of the snapshot is returned
+ * Should be called between generating frames and not from callbacks
+ *
+ * Returns the size of the snapshot
+ *
+ * Errors:
+ * BK_INVALID_VALUE if `size` is smaller than the snapshot
+ */
+extern BKInt BKContextSnapshot(BKContext const* ctx, void* outData, BKSize size);
+
+/**
+ * Set state of context and all attached objects to a snapshot written by
+ * `BKContextSnapshot`
+ * The same objects have to be attached in the same order as when the snapshot
+ * was taken; data and instruments are not copied and have to be the same
+ * where they were set, otherwise nothing is changed
+ * Scheduled events and queued commands are kept
+ *
+ * Errors:
+ * BK_INVALID_VALUE if `data` is not a snapshot
+ * BK_INVALID_STATE if the attached objects do not match the snapshot
+ */
+extern BKInt BKContextRestore(BKContext* ctx, void const* data, BKSize size);
+
 /**
  * Attach divider to specific clock
  * `type` may be one of the following values: BK_CLOCK_TYPE_EFFECT, BK_CLOCK_TYPE_BEAT
@@ -34,4 +34,33 @@ extern BKInt BKContextSetAttrInt(BKContext* ctx, BKEnum attr, BKInt value);
  */
 extern BKInt BKContextGetAttrInt(BKContext const* ctx, BKEnum attr, BKInt* outValue);
 
+/**
+ * Add clock to scheduler
+ *
+ * Errors:
+ * BK_ALLOCATION_ERROR if scheduler could not be resized
+ */
+extern BKInt BKContextAddClock(BKContext* ctx, BKClock* clock);
+
+/**
+ * Remove clock from scheduler
+ */
+extern void BKContextRemoveClock(BKContext* ctx, BKClock* clock);
+
+/**
+ * Move clock to its position in scheduler after its next tick time has changed
+ */
+extern void BKContextUpdateClock(BKContext* ctx, BKClock* clock);
+
+/**
+ * Add unit to active units
+ * Unit continues rendering at current context time
+ */
+extern void BKContextWakeUnit(BKContext* ctx, BKUnit* unit);
+
+/**
+ * Remove unit from active units
+ */
+extern void BKContextSleepUnit(BKContext* ctx, BKUnit* unit);
+
 #endif /* ! _BK_CONTEXT_INTERN_H_ */
@@ -21,6 +21,7 @@
  * IN THE SOFTWARE.
  */
 
+#include "BKAllocator.h"
 #include "BKBase.h"
 #include "BKData_internal.h"
 #include "BKTone.h"
@@ -143,7 +144,7 @@ static void BKDataResetStates(BKData* data, BKEnum event) {
 static BKInt BKDataPromoteToCopy(BKData* data) {
 	if ((data->object.flags & BK_DATA_FLAG_COPY) == 0) {
 		BKSize size = data->numFrames * data->numChannels * sizeof(BKFrame);
-		BKFrame* frames = malloc(size);
+		BKFrame* frames = BKMemAlloc(size);
 
 		if (frames == NULL) {
 			return BK_ALLOCATION_ERROR;
@@ -170,7 +171,7 @@ static void BKDataDisposeObject(BKData* data) {
 	BKDataDetach(data);
 
 	if (data->object.flags & BK_DATA_FLAG_COPY) {
-		free(data->frames);
+		BKMemFree(data->frames);
 	}
 }
 
@@ -338,10 +339,10 @@ BKInt BKDataSetFrames(BKData* data, BKFrame const* frames, BKUInt numFrames, BKU
 
 	if (copy) {
 		if (data->object.flags & BK_DATA_FLAG_COPY) {
-			newFrames = realloc(data->frames, size);
+			newFrames = BKMemRealloc(data->frames, size);
 		}
 		else {
-			newFrames = malloc(size);
+			newFrames = BKMemAlloc(size);
 		}
 
 		if (newFrames == NULL) {
@@ -354,7 +355,7 @@ BKInt BKDataSetFrames(BKData* data, BKFrame const* frames, BKUInt numFrames, BKU
 	}
 	else {
 		if (data->object.flags & BK_DATA_FLAG_COPY) {
-			free(data->frames);
+			BKMemFree(data->frames);
 		}
 
 		newFrames = (BKFrame*)frames;
@@ -569,10 +570,10 @@ BKInt BKDataSetData(BKData* data, void const* frameData, BKUInt dataSize, BKUInt
 	BKFrame* frames;
 
 	if (data->object.flags & BK_DATA_FLAG_COPY) {
-		frames = realloc(data->frames, numFrames * sizeof(BKFrame));
+		frames = BKMemRealloc(data->frames, numFrames * sizeof(BKFrame));
 	}
 	else {
-		frames = malloc(numFrames * sizeof(BKFrame));
+		frames = BKMemAlloc(numFrames * sizeof(BKFrame));
 	}
 
 	if (frames == NULL) {
@@ -607,7 +608,7 @@ BKInt BKDataLoadRaw(BKData* data, FILE* file, BKUInt numChannels, BKEnum params)
 	}
 
 	size -= offset;
-	void* frames = malloc(size);
+	void* frames = BKMemAlloc(size);
 
 	if (!frames) {
 		ret = BK_ALLOCATION_ERROR;
@@ -625,7 +626,7 @@ BKInt BKDataLoadRaw(BKData* data, FILE* file, BKUInt numChannels, BKEnum params)
 
 	error: {
 		if (frames) {
-			free(frames);
+			BKMemFree(frames);
 		}
 	}
 
@@ -648,7 +649,7 @@ BKInt BKDataLoadWAVE(BKData* data, FILE* file) {
 	}
 
 	BKSize size = numFrames * numChannels * sizeof(BKFrame);
-	BKFrame* frames = malloc(size);
+	BKFrame* frames = BKMemAlloc(size);
 
 	if (frames == NULL) {
 		BKDispose(&reader);
@@ -656,7 +657,7 @@ BKInt BKDataLoadWAVE(BKData* data, FILE* file) {
 	}
 
 	if (BKWaveFileReaderReadFrames(&reader, frames) < 0) {
-		free(frames);
+		BKMemFree(frames);
 		return BK_INVALID_RETURN_VALUE;
 	}
 
@@ -804,7 +805,7 @@ BKInt BKDataConvert(BKData* data, BKDataConvertInfo* info) {
 	}
 
 	if ((data->object.flags & BK_DATA_FLAG_COPY) == 0) {
-		convertedFrames = malloc(length * sizeof(BKFrame));
+		convertedFrames = BKMemAlloc(length * sizeof(BKFrame));
 
 		if (convertedFrames == NULL) {
 			return -1;
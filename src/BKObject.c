@@ -22,6 +22,7 @@
  */
 
 #include "BKObject.h"
+#include "BKAllocator.h"
 
 BKInt BKObjectInit(void* object, BKClass const* isa, BKSize guardSize) {
 	BKObject* obj = object;
@@ -55,7 +56,7 @@ BKInt BKObjectAlloc(void** outObject, BKClass const* isa, BKSize extraSize) {
 		return BK_ALLOCATION_ERROR;
 	}
 
-	obj = malloc(isa->instanceSize + extraSize);
+	obj = BKMemAlloc(isa->instanceSize + extraSize);
 
 	if (obj == NULL) {
 		return BK_ALLOCATION_ERROR;
@@ -161,6 +162,6 @@ void BKDispose(void* object) {
 	memset(obj, 0, isa->instanceSize);
 
 	if (flags & BKObjectFlagAllocated) {
-		free(obj);
+		BKMemFree(obj);
 	}
 }
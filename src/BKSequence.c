@@ -1,11 +1,12 @@
 #include "BKSequence.h"
+#include "BKAllocator.h"
 
 static BKInt BKSequenceFuncSimpleCreate(BKSequence** outSequence, BKSequenceFuncs const* funcs, void const* values, BKUInt length, BKUInt sustainOffset, BKUInt sustainLength) {
 	sustainOffset = BKClamp(sustainOffset, 0, length);
 	sustainLength = BKClamp(sustainLength, 0, length - sustainOffset);
 
 	BKInt size = sizeof(BKInt) * length;
-	BKSequence* sequence = malloc(sizeof(*sequence) + size);
+	BKSequence* sequence = BKMemAlloc(sizeof(*sequence) + size);
 
 	if (sequence) {
 		memset(sequence, 0, sizeof(*sequence));
@@ -109,7 +110,7 @@ static BKInt BKSequenceFuncSimpleSetValue(BKSequenceState* state, BKInt value) {
 static BKInt BKSequenceFuncSimpleCopy(BKSequence** outCopy, BKSequence const* sequence) {
 	BKInt* values;
 	BKInt size = sizeof(*values) * sequence->length;
-	BKSequence* copy = malloc(sizeof(*copy) + size);
+	BKSequence* copy = BKMemAlloc(sizeof(*copy) + size);
 
 	if (copy) {
 		values = (BKInt*)((char*)copy + sizeof(*copy));
@@ -197,7 +198,7 @@ static BKInt BKSequenceFuncEnvelopeCreate(BKSequence** outSequence, BKSequenceFu
 	}
 
 	BKInt size = sizeof(BKSequencePhase) * length;
-	BKSequence* sequence = malloc(sizeof(*sequence) + size);
+	BKSequence* sequence = BKMemAlloc(sizeof(*sequence) + size);
 
 	if (sequence) {
 		memset(sequence, 0, sizeof(*sequence));
@@ -352,7 +353,7 @@ static BKInt BKSequenceFuncEnvelopeCopy(BKSequence** outCopy, BKSequence const*
 	BKSequencePhase* values;
 
 	size = sizeof(*values) * sequence->length;
-	copy = malloc(sizeof(*copy) + size);
+	copy = BKMemAlloc(sizeof(*copy) + size);
 
 	if (copy) {
 		values = (BKSequencePhase*)((char*)copy + sizeof(*copy));
@@ -444,7 +445,7 @@ BKInt BKSequenceCopy(BKSequence** outSequence, BKSequence* sequence) {
 }
 
 void BKSequenceDispose(BKSequence* sequence) {
-	free(sequence);
+	BKMemFree(sequence);
 }
 
 BKInt BKSequenceStateSetPhase(BKSequenceState* state, BKEnum phase) {
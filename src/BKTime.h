@@ -37,7 +37,7 @@
 #define BK_TIME_MAX INT64_MAX
 
 BK_INLINE BKTime BKTimeMake(BKInt samples, BKFUInt20 frac) {
-	return (samples << BK_FINT20_SHIFT) + frac;
+	return ((BKTime)samples << BK_FINT20_SHIFT) + frac;
 }
 
 BK_INLINE BKInt BKTimeGetTime(BKTime a) {
@@ -52,6 +52,10 @@ BK_INLINE BKFUInt20 BKTimeGetFUInt20(BKTime a) {
 	return (BKFUInt20)a;
 }
 
+BK_INLINE BKFUInt64 BKTimeGetFUInt64(BKTime a) {
+	return (BKFUInt64)a;
+}
+
 BK_INLINE BKTime BKTimeAdd(BKTime a, BKTime b) {
 	return a + b;
 }
@@ -60,6 +64,10 @@ BK_INLINE BKTime BKTimeAddFUInt20(BKTime a, BKFUInt20 b) {
 	return a + (BKTime)b;
 }
 
+BK_INLINE BKTime BKTimeAddFUInt64(BKTime a, BKFUInt64 b) {
+	return a + (BKTime)b;
+}
+
 BK_INLINE BKTime BKTimeSub(BKTime a, BKTime b) {
 	return a - b;
 }
@@ -92,6 +100,10 @@ BK_INLINE BKInt BKTimeIsLessFUInt20(BKTime a, BKFUInt20 b) {
 	return a < (BKTime)b;
 }
 
+BK_INLINE BKInt BKTimeIsLessFUInt64(BKTime a, BKFUInt64 b) {
+	return a < (BKTime)b;
+}
+
 BK_INLINE BKInt BKTimeIsLessEqual(BKTime a, BKTime b) {
 	return a <= b;
 }
@@ -122,6 +134,10 @@ BK_INLINE BKFUInt20 BKTimeGetFUInt20(BKTime a) {
 	return (a.time << BK_FINT20_SHIFT) + a.frac;
 }
 
+BK_INLINE BKFUInt64 BKTimeGetFUInt64(BKTime a) {
+	return ((BKFUInt64)a.time << BK_FINT20_SHIFT) + a.frac;
+}
+
 BK_INLINE BKTime BKTimeAdd(BKTime a, BKTime b) {
 	BKTime time;
 	BKFUInt20 frac;
@@ -145,6 +161,17 @@ BK_INLINE BKTime BKTimeAddFUInt20(BKTime a, BKFUInt20 b) {
 	return a;
 }
 
+BK_INLINE BKTime BKTimeAddFUInt64(BKTime a, BKFUInt64 b) {
+	BKFUInt64 frac;
+
+	frac = a.frac + b;
+
+	a.frac = frac & BK_FINT20_FRAC;
+	a.time += (BKInt)(frac >> BK_FINT20_SHIFT);
+
+	return a;
+}
+
 BK_INLINE BKTime BKTimeSub(BKTime a, BKTime b) {
 	BKTime time;
 	BKFUInt20 frac;
@@ -196,6 +223,12 @@ BK_INLINE BKInt BKTimeIsLessFUInt20(BKTime a, BKFUInt20 b) {
 	return BKTimeIsLess(a, time);
 }
 
+BK_INLINE BKInt BKTimeIsLessFUInt64(BKTime a, BKFUInt64 b) {
+	BKTime time = { (BKInt)(b >> BK_FINT20_SHIFT), (BKFUInt20)b & BK_FINT20_FRAC };
+
+	return BKTimeIsLess(a, time);
+}
+
 BK_INLINE BKInt BKTimeIsLessEqual(BKTime a, BKTime b) {
 	return (a.time < b.time) || ((a.time == b.time) && (a.frac <= b.frac));
 }
@@ -36,10 +36,38 @@ extern BKInt const sequenceDefaultValue[BK_MAX_SEQUENCES];
 void BKTrackReset(BKTrack* track);
 
 static void BKTrackUpdateUnit(BKTrack* track);
-static BKInt BKTrackRun(BKTrack* track, BKFUInt20 endTime);
+static BKInt BKTrackRun(BKTrack* track, BKFUInt64 endTime);
+static BKInt BKTrackSkip(BKTrack* track, BKFUInt64 endTime);
+static BKInt BKTrackSave(BKTrack const* track, void* outState);
+static BKInt BKTrackRestore(BKTrack* track, void const* inState, BKInt check);
 static void BKTrackSetNote(BKTrack* track, BKInt note);
 static void BKTrackSetInstrument(BKTrack* track, BKInstrument* instrument);
 static void BKTrackInstrumentUpdateFlags(BKTrack* track, BKInt all);
+static void BKTrackWakeUnit(BKTrack* track);
+
+/**
+ * Track values following the unit state
+ * Sample, instrument and sequences are referenced by their address and are not copied
+ */
+typedef struct {
+	BKUInt flags;
+	unsigned char values[offsetof(BKTrack, sample) - offsetof(BKTrack, arpeggioDivider)];
+	void const* sample; // only compared
+	unsigned char moreValues[offsetof(BKTrack, instrState) - offsetof(BKTrack, samplePitch)];
+	void const* instrument; // only compared
+	BKUInt instrPhase;
+	BKInt numActiveSequences;
+	struct {
+		void const* sequence; // only compared
+		BKEnum phase;
+		BKInt steps;
+		BKInt delta;
+		BKInt offset;
+		BKInt value;
+		BKInt shiftedValue;
+		BKInt endValue;
+	} states[BK_MAX_SEQUENCES];
+} BKTrackState;
 
 static BKInt BKTrackInstrStateCallback(BKEnum event, BKTrack* track) {
 	switch (event) {
@@ -58,6 +86,8 @@ static BKInt BKTrackInstrStateCallback(BKEnum event, BKTrack* track) {
 		}
 	}
 
+	BKTrackWakeUnit(track);
+
 	return 0;
 }
 
@@ -146,7 +176,14 @@ static void BKTrackUpdateUnitNote(BKTrack* track) {
 
 	if (track->waveform != BK_SAMPLE) {
 		BKInt period = BKTonePeriodLookup(note, track->unit.ctx->sampleRate);
-		period /= BKMin(track->unit.phase.count, BK_WAVE_MAX_LENGTH);
+
+		if (track->waveform == BK_WAVETABLE) {
+			period /= track->unit.phase.count;
+		}
+		else {
+			period /= BKMin(track->unit.phase.count, BK_WAVE_MAX_LENGTH);
+		}
+
 		BKUnitSetAttr(&track->unit, BK_PERIOD, period);
 	}
 	else {
@@ -185,6 +222,17 @@ static void BKTrackUpdateUnit(BKTrack* track) {
 	}
 }
 
+/**
+ * Run sleeping unit to apply pending attribute updates
+ */
+static void BKTrackWakeUnit(BKTrack* track) {
+	BKUInt updateMask = BKTrackAttrUpdateFlagVolume | BKTrackAttrUpdateFlagNote | BKTrackAttrUpdateFlagDutyCycle;
+
+	if (track->unit.ctx && (track->flags & updateMask)) {
+		BKContextWakeUnit(track->unit.ctx, &track->unit);
+	}
+}
+
 static void BKTrackUpdateIgnoreVolume(BKTrack* track) {
 	BKInt ignoreVolume = track->waveform == BK_TRIANGLE && (track->flags & BKTriangleIgnoresVolumeFlag);
 
@@ -343,6 +391,8 @@ static BKEnum BKTrackTick(BKCallbackInfo* info, BKTrack* track) {
 		}
 	}
 
+	BKTrackWakeUnit(track);
+
 	return 0;
 }
 
@@ -367,7 +417,10 @@ static BKInt BKTrackInitGeneric(BKTrack* track, BKEnum waveform) {
 
 	track->flags |= BKTriangleIgnoresVolumeFlag;
 	track->unit.run = (BKUnitRunFunc)BKTrackRun;
+	track->unit.skip = (BKUnitSkipFunc)BKTrackSkip;
 	track->unit.reset = (BKUnitResetFunc)BKTrackReset;
+	track->unit.save = (BKUnitSaveFunc)BKTrackSave;
+	track->unit.restore = (BKUnitRestoreFunc)BKTrackRestore;
 
 	// init waveform flags
 	BKSetAttr(track, BK_WAVEFORM, waveform);
@@ -415,12 +468,118 @@ BKInt BKTrackAlloc(BKTrack** outTrack, BKEnum waveform) {
 	return 0;
 }
 
-static BKInt BKTrackRun(BKTrack* track, BKFUInt20 endTime) {
+static BKInt BKTrackRun(BKTrack* track, BKFUInt64 endTime) {
 	BKTrackUpdateUnit(track);
 
 	return BKUnitRun(&track->unit, endTime);
 }
 
+static BKInt BKTrackSkip(BKTrack* track, BKFUInt64 endTime) {
+	BKTrackUpdateUnit(track);
+
+	return BKUnitSkip(&track->unit, endTime);
+}
+
+static BKInt BKTrackSave(BKTrack const* track, void* outState) {
+	BKInt size = BKUnitSave(&track->unit, outState);
+	BKTrackState state;
+
+	if (outState) {
+		memset(&state, 0, sizeof(state));
+
+		state.flags = track->flags;
+		state.instrument = track->instrState.instrument;
+		state.instrPhase = track->instrState.phase;
+		state.numActiveSequences = track->instrState.numActiveSequences;
+
+		state.sample = track->sample;
+
+		// fields from `arpeggioDivider` to `dutyCycle` and from `samplePitch` to `arpeggio`
+		memcpy(state.values, &track->arpeggioDivider, sizeof(state.values));
+		memcpy(state.moreValues, &track->samplePitch, sizeof(state.moreValues));
+
+		for (BKInt i = 0; i < BK_MAX_SEQUENCES; i++) {
+			BKSequenceState const* sequenceState = &track->instrState.states[i];
+
+			state.states[i].sequence = sequenceState->sequence;
+			state.states[i].phase = sequenceState->phase;
+			state.states[i].steps = sequenceState->steps;
+			state.states[i].delta = sequenceState->delta;
+			state.states[i].offset = sequenceState->offset;
+			state.states[i].value = sequenceState->value;
+			state.states[i].shiftedValue = sequenceState->shiftedValue;
+			state.states[i].endValue = sequenceState->endValue;
+		}
+
+		memcpy((char*)outState + size, &state, sizeof(state));
+	}
+
+	return size + sizeof(state);
+}
+
+static BKInt BKTrackRestore(BKTrack* track, void const* inState, BKInt check) {
+	BKInt size = BKUnitSave(&track->unit, NULL);
+	BKTrackState state;
+	BKInt res;
+
+	memcpy(&state, (char const*)inState + size, sizeof(state));
+
+	if (check) {
+		res = BKUnitRestore(&track->unit, inState, 1);
+
+		if (res < 0) {
+			return res;
+		}
+
+		// sample is not copied and has to be the same
+		if (state.sample != (void const*)track->sample) {
+			return BK_INVALID_STATE;
+		}
+
+		// instrument is not copied and has to be the same if set
+		if (state.instrument) {
+			if (state.instrument != (void const*)track->instrState.instrument) {
+				return BK_INVALID_STATE;
+			}
+
+			for (BKInt i = 0; i < BK_MAX_SEQUENCES; i++) {
+				if (state.states[i].sequence != (void const*)track->instrState.states[i].sequence) {
+					return BK_INVALID_STATE;
+				}
+			}
+		}
+
+		return 0;
+	}
+
+	if (state.instrument == NULL) {
+		BKInstrumentStateSetInstrument(&track->instrState, NULL);
+	}
+
+	BKUnitRestore(&track->unit, inState, 0);
+
+	track->flags = state.flags;
+	track->instrState.phase = state.instrPhase;
+	track->instrState.numActiveSequences = state.numActiveSequences;
+
+	memcpy(&track->arpeggioDivider, state.values, sizeof(state.values));
+	memcpy(&track->samplePitch, state.moreValues, sizeof(state.moreValues));
+
+	for (BKInt i = 0; i < BK_MAX_SEQUENCES; i++) {
+		BKSequenceState* sequenceState = &track->instrState.states[i];
+
+		sequenceState->phase = state.states[i].phase;
+		sequenceState->steps = state.states[i].steps;
+		sequenceState->delta = state.states[i].delta;
+		sequenceState->offset = state.states[i].offset;
+		sequenceState->value = state.states[i].value;
+		sequenceState->shiftedValue = state.states[i].shiftedValue;
+		sequenceState->endValue = state.states[i].endValue;
+	}
+
+	return 0;
+}
+
 void BKTrackReset(BKTrack* track) {
 	BKUnitReset(&track->unit);
 	BKSetAttr(track, BK_DUTY_CYCLE, BK_SQUARE_PHASES / 4);
@@ -722,6 +881,8 @@ static BKInt BKTrackSetAttrInt(BKTrack* track, BKEnum attr, BKInt value) {
 		}
 	}
 
+	BKTrackWakeUnit(track);
+
 	return ret;
 }
 
@@ -875,6 +1036,8 @@ BKInt BKTrackSetEffect(BKTrack* track, BKEnum effect, void const* inValues, BKUI
 		track->flags &= ~flag;
 	}
 
+	BKTrackWakeUnit(track);
+
 	return 0;
 }
 
@@ -930,7 +1093,8 @@ static BKInt BKTrackSetPtrObj(BKTrack* track, BKEnum attr, void* ptr, BKSize siz
 		default: {
 			switch (attr) {
 				case BK_WAVEFORM:
-				case BK_SAMPLE: {
+				case BK_SAMPLE:
+				case BK_WAVETABLE: {
 					BKInt oldAttr = 0;
 					BKUnitGetAttr(&track->unit, BK_WAVEFORM, &oldAttr);
 
@@ -993,6 +1157,8 @@ static BKInt BKTrackSetPtrObj(BKTrack* track, BKEnum attr, void* ptr, BKSize siz
 		}
 	}
 
+	BKTrackWakeUnit(track);
+
 	return 0;
 }
 
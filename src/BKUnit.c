@@ -21,17 +21,24 @@
  * IN THE SOFTWARE.
  */
 
+#include "BKAllocator.h"
+#include "BKContext_internal.h"
 #include "BKData_internal.h"
 #include "BKUnit_internal.h"
 
 #define MAV BK_MAX_VOLUME
 #define MIV -BK_MAX_VOLUME
 
+#define BK_SINC_INTERP_PHASES 32
+#define BK_SINC_INTERP_TAPS 8
+#define BK_SINC_INTERP_SHIFT 14
+#define BK_SINC_INTERP_MAX_SCALE 8 // maximum factor the kernel is widened by when pitching up
+
 extern BKClass BKUnitClass;
 
 // clang-format off
 
-static BKFrame const squarePhases[BK_SQUARE_PHASES + 1][BK_SQUARE_PHASES] = {
+BKFrame const BKUnitSquarePhases[BK_SQUARE_PHASES + 1][BK_SQUARE_PHASES] = {
 	{  0,   MAV, 0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0},
 	{  0,   MAV, 0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0},
 	{  0,   0,   MAV, MAV, 0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0},
@@ -52,29 +59,257 @@ static BKFrame const squarePhases[BK_SQUARE_PHASES + 1][BK_SQUARE_PHASES] = {
 	{  MIV, MIV, MIV, MIV, MIV, MIV, MIV, MIV, MIV, MIV, MIV, MIV, MIV, MIV, MIV, 0},
 };
 
-static BKFrame const trianglePhases[BK_TRIANGLE_PHASES] = {
+/**
+ * Number of steps from each square phase to the next value change
+ */
+unsigned char const BKUnitSquareEdges[BK_SQUARE_PHASES + 1][BK_SQUARE_PHASES] = {
+	{ 1,  1, 15, 14, 13, 12, 11, 10,  9,  8,  7,  6,  5,  4,  3,  2},
+	{ 1,  1, 15, 14, 13, 12, 11, 10,  9,  8,  7,  6,  5,  4,  3,  2},
+	{ 2,  1,  2,  1, 14, 13, 12, 11, 10,  9,  8,  7,  6,  5,  4,  3},
+	{ 2,  1,  3,  2,  1, 13, 12, 11, 10,  9,  8,  7,  6,  5,  4,  3},
+	{ 3,  2,  1,  4,  3,  2,  1, 12, 11, 10,  9,  8,  7,  6,  5,  4},
+	{ 3,  2,  1,  5,  4,  3,  2,  1, 11, 10,  9,  8,  7,  6,  5,  4},
+	{ 4,  3,  2,  1,  6,  5,  4,  3,  2,  1, 10,  9,  8,  7,  6,  5},
+	{ 4,  3,  2,  1,  7,  6,  5,  4,  3,  2,  1,  9,  8,  7,  6,  5},
+	{ 5,  4,  3,  2,  1,  8,  7,  6,  5,  4,  3,  2,  1,  8,  7,  6},
+
+	{ 6,  5,  4,  3,  2,  1,  9,  8,  7,  6,  5,  4,  3,  2,  1,  7},
+	{ 5,  4,  3,  2,  1, 10,  9,  8,  7,  6,  5,  4,  3,  2,  1,  6},
+	{ 4,  3,  2,  1, 11, 10,  9,  8,  7,  6,  5,  4,  3,  2,  1,  5},
+	{ 3,  2,  1, 12, 11, 10,  9,  8,  7,  6,  5,  4,  3,  2,  1,  4},
+	{ 2,  1, 13, 12, 11, 10,  9,  8,  7,  6,  5,  4,  3,  2,  1,  3},
+	{ 1, 14, 13, 12, 11, 10,  9,  8,  7,  6,  5,  4,  3,  2,  1,  2},
+	{15, 14, 13, 12, 11, 10,  9,  8,  7,  6,  5,  4,  3,  2,  1,  1},
+	{15, 14, 13, 12, 11, 10,  9,  8,  7,  6,  5,  4,  3,  2,  1,  1},
+};
+
+BKFrame const BKUnitTrianglePhases[BK_TRIANGLE_PHASES] = {
 	     0,   2047,   4095,   6143,   8191,  10239,  12287,  14335,
 	 14335,  12287,  10239,   8191,   6143,   4095,   2047,      0,
 	 -2047,  -4095,  -6143,  -8191, -10239, -12287, -14335, -16383,
 	-16383, -14335, -12287, -10239,  -8191,  -6143,  -4095,  -2047,
 };
 
-static BKFrame const sawtoothPhases[BK_SAWTOOTH_PHASES] = {
+/**
+ * Next 4 output bits of the noise generator indexed by the lowest 9 bits of its state
+ * The first output is in the lowest bit
+ */
+unsigned char const BKUnitNoiseBits[1 << BK_NOISE_TABLE_BITS] = {
+	 0,  1,  2,  3,  5,  4,  7,  6, 11, 10,  9,  8, 14, 15, 12, 13,
+	 6,  7,  4,  5,  3,  2,  1,  0, 13, 12, 15, 14,  8,  9, 10, 11,
+	13, 12, 15, 14,  8,  9, 10, 11,  6,  7,  4,  5,  3,  2,  1,  0,
+	11, 10,  9,  8, 14, 15, 12, 13,  0,  1,  2,  3,  5,  4,  7,  6,
+	10, 11,  8,  9, 15, 14, 13, 12,  1,  0,  3,  2,  4,  5,  6,  7,
+	12, 13, 14, 15,  9,  8, 11, 10,  7,  6,  5,  4,  2,  3,  0,  1,
+	 7,  6,  5,  4,  2,  3,  0,  1, 12, 13, 14, 15,  9,  8, 11, 10,
+	 1,  0,  3,  2,  4,  5,  6,  7, 10, 11,  8,  9, 15, 14, 13, 12,
+	 4,  5,  6,  7,  1,  0,  3,  2, 15, 14, 13, 12, 10, 11,  8,  9,
+	 2,  3,  0,  1,  7,  6,  5,  4,  9,  8, 11, 10, 12, 13, 14, 15,
+	 9,  8, 11, 10, 12, 13, 14, 15,  2,  3,  0,  1,  7,  6,  5,  4,
+	15, 14, 13, 12, 10, 11,  8,  9,  4,  5,  6,  7,  1,  0,  3,  2,
+	14, 15, 12, 13, 11, 10,  9,  8,  5,  4,  7,  6,  0,  1,  2,  3,
+	 8,  9, 10, 11, 13, 12, 15, 14,  3,  2,  1,  0,  6,  7,  4,  5,
+	 3,  2,  1,  0,  6,  7,  4,  5,  8,  9, 10, 11, 13, 12, 15, 14,
+	 5,  4,  7,  6,  0,  1,  2,  3, 14, 15, 12, 13, 11, 10,  9,  8,
+	 8,  9, 10, 11, 13, 12, 15, 14,  3,  2,  1,  0,  6,  7,  4,  5,
+	14, 15, 12, 13, 11, 10,  9,  8,  5,  4,  7,  6,  0,  1,  2,  3,
+	 5,  4,  7,  6,  0,  1,  2,  3, 14, 15, 12, 13, 11, 10,  9,  8,
+	 3,  2,  1,  0,  6,  7,  4,  5,  8,  9, 10, 11, 13, 12, 15, 14,
+	 2,  3,  0,  1,  7,  6,  5,  4,  9,  8, 11, 10, 12, 13, 14, 15,
+	 4,  5,  6,  7,  1,  0,  3,  2, 15, 14, 13, 12, 10, 11,  8,  9,
+	15, 14, 13, 12, 10, 11,  8,  9,  4,  5,  6,  7,  1,  0,  3,  2,
+	 9,  8, 11, 10, 12, 13, 14, 15,  2,  3,  0,  1,  7,  6,  5,  4,
+	12, 13, 14, 15,  9,  8, 11, 10,  7,  6,  5,  4,  2,  3,  0,  1,
+	10, 11,  8,  9, 15, 14, 13, 12,  1,  0,  3,  2,  4,  5,  6,  7,
+	 1,  0,  3,  2,  4,  5,  6,  7, 10, 11,  8,  9, 15, 14, 13, 12,
+	 7,  6,  5,  4,  2,  3,  0,  1, 12, 13, 14, 15,  9,  8, 11, 10,
+	 6,  7,  4,  5,  3,  2,  1,  0, 13, 12, 15, 14,  8,  9, 10, 11,
+	 0,  1,  2,  3,  5,  4,  7,  6, 11, 10,  9,  8, 14, 15, 12, 13,
+	11, 10,  9,  8, 14, 15, 12, 13,  0,  1,  2,  3,  5,  4,  7,  6,
+	13, 12, 15, 14,  8,  9, 10, 11,  6,  7,  4,  5,  3,  2,  1,  0,
+};
+
+BKFrame const BKUnitSawtoothPhases[BK_SAWTOOTH_PHASES] = {
 	 32766,  27305,  21844,  16383,  10922,   5461,      0,
 };
 
-static BKFrame const sinePhases[BK_SINE_PHASES] = {
+BKFrame const BKUnitSinePhases[BK_SINE_PHASES] = {
 	     0,   6392,  12539,  18204,  23169,  27244,  30272,  32137,
 	 32767,  32137,  30272,  27244,  23169,  18204,  12539,   6392,
 	     0,  -6392, -12539, -18204, -23169, -27244, -30272, -32137,
 	-32767, -32137, -30272, -27244, -23169, -18204, -12539,  -6392,
 };
 
+/**
+ * Blackman windowed sinc with taps from -3 to +4 frames
+ * Each phase sums up to 1 << BK_SINC_INTERP_SHIFT
+ */
+static BKFrame const sincInterpPhases[BK_SINC_INTERP_PHASES][BK_SINC_INTERP_TAPS] = {
+	{     0,      0,      0,  16384,      0,      0,      0,      0},
+	{   -10,     82,   -377,  16353,    415,    -91,     12,      0},
+	{   -19,    156,   -716,  16263,    866,   -192,     26,      0},
+	{   -26,    220,  -1017,  16110,   1354,   -300,     43,      0},
+	{   -31,    275,  -1280,  15900,   1875,   -416,     61,      0},
+	{   -35,    321,  -1505,  15634,   2428,   -538,     80,     -1},
+	{   -38,    358,  -1694,  15311,   3012,   -666,    102,     -1},
+	{   -39,    386,  -1848,  14938,   3623,   -799,    125,     -2},
+	{   -40,    407,  -1968,  14515,   4258,   -935,    150,     -3},
+	{   -39,    421,  -2055,  14044,   4915,  -1072,    175,     -5},
+	{   -38,    427,  -2111,  13532,   5589,  -1210,    202,     -7},
+	{   -36,    428,  -2139,  12977,   6278,  -1345,    229,     -8},
+	{   -34,    422,  -2141,  12393,   6976,  -1478,    257,    -11},
+	{   -31,    412,  -2118,  11774,   7680,  -1604,    284,    -13},
+	{   -28,    398,  -2073,  11131,   8385,  -1723,    310,    -16},
+	{   -25,    380,  -2009,  10465,   9088,  -1831,    335,    -19},
+	{   -22,    359,  -1928,   9783,   9783,  -1928,    359,    -22},
+	{   -19,    335,  -1831,   9088,  10465,  -2009,    380,    -25},
+	{   -16,    310,  -1723,   8385,  11131,  -2073,    398,    -28},
+	{   -13,    284,  -1604,   7680,  11774,  -2118,    412,    -31},
+	{   -11,    257,  -1478,   6976,  12393,  -2141,    422,    -34},
+	{    -8,    229,  -1345,   6278,  12977,  -2139,    428,    -36},
+	{    -7,    202,  -1210,   5589,  13532,  -2111,    427,    -38},
+	{    -5,    175,  -1072,   4915,  14044,  -2055,    421,    -39},
+	{    -3,    150,   -935,   4258,  14515,  -1968,    407,    -40},
+	{    -2,    125,   -799,   3623,  14938,  -1848,    386,    -39},
+	{    -1,    102,   -666,   3012,  15311,  -1694,    358,    -38},
+	{    -1,     80,   -538,   2428,  15634,  -1505,    321,    -35},
+	{     0,     61,   -416,   1875,  15900,  -1280,    275,    -31},
+	{     0,     43,   -300,   1354,  16110,  -1017,    220,    -26},
+	{     0,     26,   -192,    866,  16263,   -716,    156,    -19},
+	{     0,     12,    -91,    415,  16353,   -377,     82,    -10},
+};
+
 // clang-format on
 
 static BKEnum BKUnitCallSampleCallback(BKUnit* unit, BKEnum event);
 static void BKUnitUpdateSampleSustainRange(BKUnit* unit, BKInt offset, BKInt end);
 
+BKInt BKUnitIsIdle(BKUnit const* unit) {
+	if (!unit->period || unit->mute) {
+		return 1;
+	}
+
+	switch (unit->waveform) {
+		case BK_SQUARE:
+		case BK_TRIANGLE:
+		case BK_NOISE:
+		case BK_SAWTOOTH:
+		case BK_SINE:
+		case BK_CUSTOM:
+		case BK_WAVETABLE: {
+			for (BKInt i = 0; i < unit->ctx->numChannels; i++) {
+				if (unit->volume[i]) {
+					return 0;
+				}
+			}
+
+			break;
+		}
+		case BK_SAMPLE: {
+			// sample phase advances also when silent
+			return BKAbs((BKInt)unit->sample.end - (BKInt)unit->sample.offset) < 2;
+			break;
+		}
+	}
+
+	return 1;
+}
+
+/**
+ * Add sleeping unit to active units if it is not idle anymore
+ */
+static void BKUnitUpdateActive(BKUnit* unit) {
+	if (unit->ctx && !(unit->object.flags & BKUnitFlagActive) && !unit->idle(unit)) {
+		BKContextWakeUnit(unit->ctx, unit);
+	}
+}
+
+/**
+ * Count steps from each phase of custom waveform to the next value change
+ */
+static void BKUnitUpdateCustomEdges(BKUnit* unit) {
+	BKUInt count = unit->phase.count;
+	BKFrame const* frames = unit->sample.frames;
+
+	for (BKUInt phase = 0; phase < count; phase++) {
+		BKUInt steps = 1;
+
+		while (steps < count && frames[(phase + steps) % count] == frames[phase]) {
+			steps++;
+		}
+
+		unit->customEdges[phase] = steps;
+	}
+}
+
+static void BKUnitFreeWavetable(BKUnit* unit) {
+	BKMemFree(unit->wavetable.frames);
+	unit->wavetable.frames = NULL;
+	unit->wavetable.numLevels = 0;
+}
+
+/**
+ * Resample first channel of `data` to a power of 2 and reduce it to mipmaps
+ * Each level is low-pass filtered with a half-band filter and decimated by 2
+ */
+static BKInt BKUnitBuildWavetable(BKUnit* unit, BKData const* data) {
+	BKUInt numFrames = data->numFrames;
+	BKUInt numChannels = data->numChannels;
+	BKUInt length = 2;
+	BKUInt numLevels = 1;
+
+	while (length < numFrames && length < BK_WAVETABLE_MAX_LENGTH) {
+		length <<= 1;
+		numLevels++;
+	}
+
+	// levels take twice the frames of level 0
+	BKFrame* frames = BKMemAlloc(2 * length * sizeof(BKFrame));
+
+	if (!frames) {
+		return BK_ALLOCATION_ERROR;
+	}
+
+	// linear interpolation over cycle
+	for (BKUInt i = 0; i < length; i++) {
+		BKFUInt64 pos = ((BKFUInt64)i * numFrames << BK_FINT20_SHIFT) / length;
+		BKUInt index = (BKUInt)(pos >> BK_FINT20_SHIFT);
+		BKInt frac = (BKInt)(pos & BK_FINT20_FRAC) >> 6;
+		BKInt a = data->frames[index * numChannels];
+		BKInt b = data->frames[((index + 1) % numFrames) * numChannels];
+
+		frames[i] = a + (((b - a) * frac) >> (BK_FINT20_SHIFT - 6));
+	}
+
+	BKFrame const* level = frames;
+
+	for (BKUInt size = length; size > 2; size >>= 1) {
+		BKFrame* next = (BKFrame*)level + size;
+		BKUInt mask = size - 1;
+
+		// coefficients -1, 0, 9, 16, 9, 0, -1
+		for (BKUInt i = 0; i < size / 2; i++) {
+			BKUInt j = i * 2;
+			BKInt sum = 16 * level[j];
+
+			sum += 9 * (level[(j - 1) & mask] + level[(j + 1) & mask]);
+			sum -= level[(j - 3) & mask] + level[(j + 3) & mask];
+
+			next[i] = BKClamp(sum >> 5, -(BKInt)BK_FRAME_MAX - 1, (BKInt)BK_FRAME_MAX);
+		}
+
+		level = next;
+	}
+
+	BKUnitFreeWavetable(unit);
+
+	unit->wavetable.frames = frames;
+	unit->wavetable.numLevels = numLevels;
+	unit->phase.count = length;
+
+	return 0;
+}
+
 static BKInt BKUnitTrySetData(BKUnit* unit, BKData* data, BKEnum type, BKEnum event) {
 	BKContext* ctx = unit->ctx;
 
@@ -94,6 +329,7 @@ static BKInt BKUnitTrySetData(BKUnit* unit, BKData* data, BKEnum type, BKEnum ev
 					unit->sample.end = data->numFrames;
 					unit->sample.frames = data->frames;
 					unit->sample.repeatCount = 0;
+					BKUnitUpdateCustomEdges(unit);
 				}
 				else {
 					return BK_INVALID_NUM_FRAMES;
@@ -110,6 +346,32 @@ static BKInt BKUnitTrySetData(BKUnit* unit, BKData* data, BKEnum type, BKEnum ev
 
 			break;
 		}
+		// set data as wavetable
+		case BK_WAVETABLE: {
+			if (data && event != BK_DATA_STATE_EVENT_DISPOSE) {
+				if (data->numFrames >= 2) {
+					BKInt res = BKUnitBuildWavetable(unit, data);
+
+					if (res < 0) {
+						return res;
+					}
+
+					unit->waveform = BK_WAVETABLE;
+					unit->phase.phase = 0;
+				}
+				else {
+					return BK_INVALID_NUM_FRAMES;
+				}
+			}
+			// data was disposed
+			else if (unit->waveform == BK_WAVETABLE) {
+				unit->waveform = 0;
+				BKUnitFreeWavetable(unit);
+				return -1;
+			}
+
+			break;
+		}
 		// set sample to play
 		case BK_SAMPLE: {
 			if (data && event != BK_DATA_STATE_EVENT_DISPOSE) {
@@ -171,12 +433,17 @@ static BKInt BKUnitSetData(BKUnit* unit, BKEnum type, BKData* data) {
 
 	if (res == 0) {
 		BKDataStateSetData(&unit->sample.dataState, data);
+
+		if (unit->waveform != BK_WAVETABLE) {
+			BKUnitFreeWavetable(unit);
+		}
 	}
 	// unset data when failed
 	else {
 		switch (unit->waveform) {
 			case BK_CUSTOM:
-			case BK_SAMPLE: {
+			case BK_SAMPLE:
+			case BK_WAVETABLE: {
 				unit->waveform = 0;
 				break;
 			}
@@ -198,6 +465,10 @@ BKInt BKUnitSampleDataStateCallback(BKEnum event, BKUnit* unit) {
 			type = BK_SAMPLE;
 			break;
 		}
+		case BK_WAVETABLE: {
+			type = BK_WAVETABLE;
+			break;
+		}
 		default: {
 			return -1;
 			break;
@@ -205,7 +476,11 @@ BKInt BKUnitSampleDataStateCallback(BKEnum event, BKUnit* unit) {
 	}
 
 	// reset data
-	return BKUnitTrySetData(unit, unit->sample.dataState.data, type, event);
+	BKInt res = BKUnitTrySetData(unit, unit->sample.dataState.data, type, event);
+
+	BKUnitUpdateActive(unit);
+
+	return res;
 }
 
 static BKEnum BKUnitCallSampleCallback(BKUnit* unit, BKEnum event) {
@@ -229,8 +504,12 @@ BKInt BKUnitInit(BKUnit* unit, BKEnum waveform) {
 	}
 
 	unit->run = (BKUnitRunFunc)BKUnitRun;
+	unit->skip = (BKUnitSkipFunc)BKUnitSkip;
 	unit->end = (BKUnitEndFunc)BKUnitEnd;
 	unit->reset = (BKUnitResetFunc)BKUnitReset;
+	unit->idle = (BKUnitIdleFunc)BKUnitIsIdle;
+	unit->save = (BKUnitSaveFunc)BKUnitSave;
+	unit->restore = (BKUnitRestoreFunc)BKUnitRestore;
 
 	BKSetAttr(unit, BK_DUTY_CYCLE, BK_DEFAULT_DUTY_CYCLE);
 	BKSetAttr(unit, BK_WAVEFORM, waveform);
@@ -245,6 +524,7 @@ BKInt BKUnitInit(BKUnit* unit, BKEnum waveform) {
 
 void BKUnitDisposeObject(BKUnit* unit) {
 	BKDataStateSetData(&unit->sample.dataState, NULL);
+	BKUnitFreeWavetable(unit);
 
 	BKUnitDetach(unit);
 }
@@ -254,6 +534,7 @@ BKInt BKUnitAttach(BKUnit* unit, BKContext* ctx) {
 		unit->prevUnit = ctx->lastUnit;
 		unit->nextUnit = NULL;
 		unit->ctx = ctx;
+		unit->channels = ctx->channels;
 		unit->time = ctx->deltaTime; // shift time to context time
 
 		if (ctx->lastUnit) {
@@ -265,6 +546,9 @@ BKInt BKUnitAttach(BKUnit* unit, BKContext* ctx) {
 			ctx->firstUnit = unit;
 			ctx->lastUnit = unit;
 		}
+
+		// sleeps after first run if idle
+		BKContextWakeUnit(ctx, unit);
 	}
 	else {
 		return BK_INVALID_STATE;
@@ -277,6 +561,8 @@ void BKUnitDetach(BKUnit* unit) {
 	BKContext* ctx = unit->ctx;
 
 	if (ctx) {
+		BKContextSleepUnit(ctx, unit);
+
 		if (unit->prevUnit) {
 			unit->prevUnit->nextUnit = unit->nextUnit;
 		}
@@ -294,6 +580,7 @@ void BKUnitDetach(BKUnit* unit) {
 		}
 
 		unit->ctx = NULL;
+		unit->channels = NULL;
 		unit->time = 0;
 	}
 }
@@ -516,6 +803,23 @@ BKInt BKUnitSetAttr(BKUnit* unit, BKEnum attr, BKInt value) {
 			unit->sample.repeatMode = value;
 			break;
 		}
+		case BK_SAMPLE_INTERPOLATION: {
+			switch (value) {
+				case BK_INTERPOLATION_NONE:
+				case BK_INTERPOLATION_LINEAR:
+				case BK_INTERPOLATION_CUBIC:
+				case BK_INTERPOLATION_SINC: {
+					break;
+				}
+				default: {
+					return BK_INVALID_VALUE;
+					break;
+				}
+			}
+
+			unit->sample.interpolation = value;
+			break;
+		}
 		case BK_SAMPLE_PERIOD: {
 			value = BKAbs(value);
 			value = BKClamp(value, BK_MIN_SAMPLE_PERIOD, BK_MAX_SAMPLE_PERIOD);
@@ -552,12 +856,20 @@ BKInt BKUnitSetAttr(BKUnit* unit, BKEnum attr, BKInt value) {
 
 			break;
 		}
+#if BK_USE_PROFILING
+		case BK_PROFILE: {
+			memset(&unit->profile, 0, sizeof(unit->profile));
+			break;
+		}
+#endif
 		default: {
 			return BK_INVALID_ATTRIBUTE;
 			break;
 		}
 	}
 
+	BKUnitUpdateActive(unit);
+
 	return 0;
 }
 
@@ -608,6 +920,10 @@ BKInt BKUnitGetAttr(BKUnit const* unit, BKEnum attr, BKInt* outValue) {
 			value = unit->sample.repeatMode;
 			break;
 		}
+		case BK_SAMPLE_INTERPOLATION: {
+			value = unit->sample.interpolation;
+			break;
+		}
 		case BK_SAMPLE_PERIOD: {
 			value = BKAbs(unit->sample.period);
 			break;
@@ -646,7 +962,8 @@ BKInt BKUnitSetPtr(BKUnit* unit, BKEnum attr, void* ptr) {
 			break;
 		}
 		case BK_WAVEFORM:
-		case BK_SAMPLE: {
+		case BK_SAMPLE:
+		case BK_WAVETABLE: {
 			BKInt res = BKUnitSetData(unit, attr, ptr);
 
 			if (res < 0) {
@@ -700,6 +1017,8 @@ BKInt BKUnitSetPtr(BKUnit* unit, BKEnum attr, void* ptr) {
 		}
 	}
 
+	BKUnitUpdateActive(unit);
+
 	return 0;
 }
 
@@ -716,7 +1035,8 @@ BKInt BKUnitGetPtr(BKUnit const* unit, BKEnum attr, void* outPtr) {
 			// data may be set but is invalid; only return if valid
 			switch (unit->waveform) {
 				case BK_CUSTOM:
-				case BK_SAMPLE: {
+				case BK_SAMPLE:
+				case BK_WAVETABLE: {
 					*ptrRef = unit->sample.dataState.data;
 					break;
 				}
@@ -737,6 +1057,13 @@ BKInt BKUnitGetPtr(BKUnit const* unit, BKEnum attr, void* outPtr) {
 			values[1] = unit->sample.sustainEnd;
 			break;
 		}
+#if BK_USE_PROFILING
+		case BK_PROFILE: {
+			BKUnitProfile* profileRef = outPtr;
+			*profileRef = unit->profile;
+			break;
+		}
+#endif
 		default: {
 			return BK_INVALID_ATTRIBUTE;
 			break;
@@ -746,147 +1073,191 @@ BKInt BKUnitGetPtr(BKUnit const* unit, BKEnum attr, void* outPtr) {
 	return 0;
 }
 
-static BKFUInt20 BKUnitRunWaveformSquare(BKUnit* unit, BKBuffer* channel, BKInt* lastPulseRef, BKInt volume, BKFUInt20 time, BKFUInt20 endTime) {
-	BKInt dutyCycle = unit->dutyCycle;
-	BKInt lastPulse = *lastPulseRef;
-	BKUInt phase = unit->phase.phase;
+/**
+ * Limit `steps` to the number of steps needed to reach `endTime`
+ */
+BK_INLINE BKUInt BKUnitEdgeSteps(BKUInt steps, BKFUInt20 period, BKFUInt64 time, BKFUInt64 endTime) {
+	if (time + (BKFUInt64)steps * period > endTime) {
+		steps = (BKUInt)((endTime - time + period - 1) / period);
+	}
 
-	// run until time
-	for (; time < endTime; time += unit->period) {
-		BKInt pulse = squarePhases[dutyCycle][phase];
-		phase = (phase + 1) & (BK_SQUARE_PHASES - 1);
+	return steps;
+}
 
-		BKInt delta = (pulse * volume) >> BK_VOLUME_SHIFT;
+/**
+ * Add scaled pulse to all channels with nonzero volume
+ */
+static void BKUnitAddPulses(BKUnit* unit, BKFUInt64 time, BKInt pulse) {
+	BKFrame pulses[BK_MAX_CHANNELS];
+	BKInt changed = 0;
 
-		BKInt chanDelta = delta - lastPulse;
-		lastPulse = delta;
+	for (BKInt i = 0; i < unit->ctx->numChannels; i++) {
+		BKInt volume = unit->volume[i];
+		BKInt chanDelta = 0;
 
-		BKBufferAddPulse(channel, time, chanDelta);
+		if (volume) {
+			BKInt delta = (pulse * volume) >> BK_VOLUME_SHIFT;
+
+			chanDelta = delta - unit->lastPulse[i];
+			unit->lastPulse[i] = delta;
+		}
+
+		pulses[i] = chanDelta;
+		changed |= chanDelta;
+	}
+
+	if (changed) {
+		BKBufferAddPulses(unit->channels, unit->ctx->numChannels, time, pulses);
+	}
+}
+
+static BKFUInt64 BKUnitRunWaveformSquare(BKUnit* unit, BKFUInt64 time, BKFUInt64 endTime) {
+	BKInt dutyCycle = unit->dutyCycle;
+	BKUInt phase = unit->phase.phase & (BK_SQUARE_PHASES - 1);
+
+	// run until time; jump from edge to edge
+	while (time < endTime) {
+		BKUnitAddPulses(unit, time, BKUnitSquarePhases[dutyCycle][phase]);
+
+		BKUInt steps = BKUnitEdgeSteps(BKUnitSquareEdges[dutyCycle][phase], unit->period, time, endTime);
+		phase = (phase + steps) & (BK_SQUARE_PHASES - 1);
+		time += (BKFUInt64)steps * unit->period;
 	}
 
 	unit->phase.phase = phase;
-	*lastPulseRef = lastPulse;
 
 	return time;
 }
 
-static BKFUInt20 BKUnitRunWaveformTriangle(BKUnit* unit, BKBuffer* channel, BKInt* lastPulseRef, BKInt volume, BKFUInt20 time, BKFUInt20 endTime) {
-	BKInt lastPulse = *lastPulseRef;
+static BKFUInt64 BKUnitRunWaveformTriangle(BKUnit* unit, BKFUInt64 time, BKFUInt64 endTime) {
 	BKUInt phase = unit->phase.phase;
 
 	// run until time
 	for (; time < endTime; time += unit->period) {
-		BKInt pulse = trianglePhases[phase];
+		BKInt pulse = BKUnitTrianglePhases[phase];
 		phase = (phase + 1) & (BK_TRIANGLE_PHASES - 1);
 
-		BKInt delta = (pulse * volume) >> BK_VOLUME_SHIFT;
-
-		BKInt chanDelta = delta - lastPulse;
-		lastPulse = delta;
-
-		BKBufferAddPulse(channel, time, chanDelta);
+		BKUnitAddPulses(unit, time, pulse);
 	}
 
 	unit->phase.phase = phase;
-	*lastPulseRef = lastPulse;
 
 	return time;
 }
 
-static BKFUInt20 BKUnitRunWaveformNoise(BKUnit* unit, BKBuffer* channel, BKInt* lastPulseRef, BKInt volume, BKFUInt20 time, BKFUInt20 endTime) {
-	BKInt lastPulse = *lastPulseRef;
+static BKFUInt64 BKUnitRunWaveformNoise(BKUnit* unit, BKFUInt64 time, BKFUInt64 endTime) {
 	BKUInt phase = unit->phase.phase;
 	BKUInt wrap = unit->phase.wrap;
-	BKUInt wrapCount = unit->phase.wrapCount;
+	BKInt wrapCount = unit->phase.wrapCount;
+	BKInt first = 1;
 
 	// must not be 0
 	if (!phase) {
-		phase = 0x4a41;
+		phase = BK_NOISE_SEED;
 	}
 
 	// run until time
-	for (; time < endTime; time += unit->period) {
-		if (wrap) {
+	while (time < endTime) {
+		// step singly when reset is near
+		if (wrap && wrapCount <= BK_NOISE_TABLE_STEPS) {
 			if (--wrapCount <= 0) {
 				wrapCount = wrap;
-				phase = 0x4a41;
+				phase = BK_NOISE_SEED;
 			}
+
+			BKInt pulse = ((phase >> 0) ^ (phase >> 2) ^ (phase >> 3) ^ (phase >> 5)) & 1;
+			phase = (phase >> 1) | (pulse << 15);
+			pulse = pulse ? BK_MAX_VOLUME / 2 : -BK_MAX_VOLUME / 2;
+
+			BKUnitAddPulses(unit, time, pulse);
+
+			time += unit->period;
+			first = 0;
+			continue;
 		}
 
-		BKInt pulse = ((phase >> 0) ^ (phase >> 2) ^ (phase >> 3) ^ (phase >> 5)) & 1;
-		phase = (phase >> 1) | (pulse << 15);
-		pulse = pulse ? BK_MAX_VOLUME / 2 : -BK_MAX_VOLUME / 2;
+		BKUInt bits = BKUnitNoiseBits[phase & ((1 << BK_NOISE_TABLE_BITS) - 1)];
+		BKUInt last = phase >> 15; // previous output
+		BKInt steps = 0;
 
-		BKInt delta = (pulse * volume) >> BK_VOLUME_SHIFT;
+		// only add pulse when output changes
+		for (; steps < BK_NOISE_TABLE_STEPS && time < endTime; steps++, time += unit->period) {
+			BKUInt bit = (bits >> steps) & 1;
+
+			if (bit != last || first) {
+				BKUnitAddPulses(unit, time, bit ? BK_MAX_VOLUME / 2 : -BK_MAX_VOLUME / 2);
+				first = 0;
+			}
 
-		BKInt chanDelta = delta - lastPulse;
-		lastPulse = delta;
+			last = bit;
+		}
 
-		BKBufferAddPulse(channel, time, chanDelta);
+		bits &= (1 << steps) - 1;
+		phase = (phase >> steps) | (bits << (16 - steps));
+		wrapCount -= wrap ? steps : 0;
 	}
 
 	unit->phase.phase = phase;
 	unit->phase.wrapCount = wrapCount;
-	*lastPulseRef = lastPulse;
 
 	return time;
 }
 
-static BKFUInt20 BKUnitRunWaveformSawtooth(BKUnit* unit, BKBuffer* channel, BKInt* lastPulseRef, BKInt volume, BKFUInt20 time, BKFUInt20 endTime) {
-	BKInt lastPulse = *lastPulseRef;
+static BKFUInt64 BKUnitRunWaveformSawtooth(BKUnit* unit, BKFUInt64 time, BKFUInt64 endTime) {
 	BKUInt phase = unit->phase.phase;
 
 	// run until time
 	for (; time < endTime; time += unit->period) {
-		BKInt pulse = sawtoothPhases[phase];
+		BKInt pulse = BKUnitSawtoothPhases[phase];
 
 		if (++phase >= BK_SAWTOOTH_PHASES) {
 			phase = 0;
 		}
 
-		BKInt delta = (pulse * volume) >> BK_VOLUME_SHIFT;
-
-		BKInt chanDelta = delta - lastPulse;
-		lastPulse = delta;
-
-		BKBufferAddPulse(channel, time, chanDelta);
+		BKUnitAddPulses(unit, time, pulse);
 	}
 
 	unit->phase.phase = phase;
-	*lastPulseRef = lastPulse;
 
 	return time;
 }
 
-static BKFUInt20 BKUnitRunWaveformSine(BKUnit* unit, BKBuffer* channel, BKInt* lastPulseRef, BKInt volume, BKFUInt20 time, BKFUInt20 endTime) {
-	BKInt lastPulse = *lastPulseRef;
+static BKFUInt64 BKUnitRunWaveformSine(BKUnit* unit, BKFUInt64 time, BKFUInt64 endTime) {
 	BKUInt phase = unit->phase.phase;
 
 	// run until time
 	for (; time < endTime; time += unit->period) {
-		BKInt pulse = sinePhases[phase] / 2;
+		BKInt pulse = BKUnitSinePhases[phase] / 2;
 		phase = (phase + 1) & (BK_SINE_PHASES - 1);
 
-		BKInt delta = (pulse * volume) >> BK_VOLUME_SHIFT;
-
-		BKInt chanDelta = delta - lastPulse;
-		lastPulse = delta;
-
-		BKBufferAddPulse(channel, time, chanDelta);
+		BKUnitAddPulses(unit, time, pulse);
 	}
 
 	unit->phase.phase = phase;
-	*lastPulseRef = lastPulse;
 
 	return time;
 }
 
-static BKFUInt20 BKUnitRunWaveformCustom(BKUnit* unit, BKBuffer* channel, BKInt* lastPulseRef, BKInt volume, BKFUInt20 time, BKFUInt20 endTime) {
-	BKInt lastPulse = *lastPulseRef;
+static BKFUInt64 BKUnitRunWaveformCustom(BKUnit* unit, BKFUInt64 time, BKFUInt64 endTime) {
 	BKUInt phase = unit->phase.phase;
 	BKUInt wrap = unit->phase.wrap;
 	BKUInt wrapCount = unit->phase.wrapCount;
 
+	// run until time; jump from edge to edge
+	if (!wrap && phase < unit->phase.count) {
+		while (time < endTime) {
+			BKUnitAddPulses(unit, time, unit->sample.frames[phase]);
+
+			BKUInt steps = BKUnitEdgeSteps(unit->customEdges[phase], unit->period, time, endTime);
+			time += (BKFUInt64)steps * unit->period;
+			phase += steps;
+
+			if (phase >= unit->phase.count) {
+				phase -= unit->phase.count;
+			}
+		}
+	}
+
 	// run until time
 	for (; time < endTime; time += unit->period) {
 		if (wrap) {
@@ -902,76 +1273,94 @@ static BKFUInt20 BKUnitRunWaveformCustom(BKUnit* unit, BKBuffer* channel, BKInt*
 			phase = 0;
 		}
 
-		BKInt delta = (pulse * volume) >> BK_VOLUME_SHIFT;
-
-		BKInt chanDelta = delta - lastPulse;
-		lastPulse = delta;
-
-		BKBufferAddPulse(channel, time, chanDelta);
+		BKUnitAddPulses(unit, time, pulse);
 	}
 
 	unit->phase.phase = phase;
 	unit->phase.wrapCount = wrapCount;
-	*lastPulseRef = lastPulse;
 
 	return time;
 }
 
 /**
- * Fills buffer with waveform to specified time
+ * Get highest mipmap level with steps not shorter than a frame
  */
-static BKFUInt20 BKUnitRunWaveform(BKUnit* unit, BKFUInt20 endTime) {
-	BKFUInt20 time = 0;
-	BKInt origPhase = unit->phase.phase;
-	BKInt origWrapCount = unit->phase.wrapCount;
+static BKUInt BKUnitWavetableLevel(BKUnit const* unit) {
+	BKUInt level = 0;
 
-	if (unit->mute) {
-		return time;
+	while (level + 1 < unit->wavetable.numLevels && ((BKFUInt64)unit->period << level) < BK_FINT20_UNIT) {
+		level++;
 	}
 
-	// update each channel
-	for (BKInt i = 0; i < unit->ctx->numChannels; i++) {
-		BKInt volume = unit->volume[i];
+	return level;
+}
 
-		if (!volume) {
-			continue;
-		}
+/**
+ * Play wavetable from the highest mipmap level with steps not shorter than a frame
+ * Phase is counted in steps of level 0
+ */
+static BKFUInt64 BKUnitRunWaveformWavetable(BKUnit* unit, BKFUInt64 time, BKFUInt64 endTime) {
+	BKUInt length = unit->phase.count;
+	BKUInt level = BKUnitWavetableLevel(unit);
+	BKFUInt64 period = (BKFUInt64)unit->period << level;
+	BKFrame const* frames = &unit->wavetable.frames[2 * (length - (length >> level))];
+	BKUInt step = 1 << level;
+	BKUInt phase = unit->phase.phase & (length - step);
 
-		BKBuffer* channel = &unit->ctx->channels[i];
-		BKInt lastPulse = unit->lastPulse[i];
-		time = unit->time;
+	// run until time
+	for (; time < endTime; time += period) {
+		BKInt pulse = frames[phase >> level];
+		phase = (phase + step) & (length - 1);
 
-		unit->phase.phase = origPhase;
-		unit->phase.wrapCount = origWrapCount;
+		BKUnitAddPulses(unit, time, pulse);
+	}
 
-		switch (unit->waveform) {
-			case BK_SQUARE: {
-				time = BKUnitRunWaveformSquare(unit, channel, &lastPulse, volume, time, endTime);
-				break;
-			}
-			case BK_TRIANGLE: {
-				time = BKUnitRunWaveformTriangle(unit, channel, &lastPulse, volume, time, endTime);
-				break;
-			}
-			case BK_NOISE: {
-				time = BKUnitRunWaveformNoise(unit, channel, &lastPulse, volume, time, endTime);
-				break;
-			}
-			case BK_SAWTOOTH: {
-				time = BKUnitRunWaveformSawtooth(unit, channel, &lastPulse, volume, time, endTime);
-				break;
-			}
-			case BK_SINE: {
-				time = BKUnitRunWaveformSine(unit, channel, &lastPulse, volume, time, endTime);
-				break;
-			}
-			case BK_CUSTOM: {
-				time = BKUnitRunWaveformCustom(unit, channel, &lastPulse, volume, time, endTime);
-				break;
-			}
-		}
+	unit->phase.phase = phase;
 
-		unit->lastPulse[i] = lastPulse;
+	return time;
+}
+
+/**
+ * Fills buffer with waveform to specified time
+ * The waveform is walked once for all channels
+ */
+static BKFUInt64 BKUnitRunWaveform(BKUnit* unit, BKFUInt64 endTime) {
+	BKFUInt64 time = unit->time;
+
+	// muted or silent on all channels
+	if (BKUnitIsIdle(unit)) {
+		return 0;
+	}
+
+	switch (unit->waveform) {
+		case BK_SQUARE: {
+			time = BKUnitRunWaveformSquare(unit, time, endTime);
+			break;
+		}
+		case BK_TRIANGLE: {
+			time = BKUnitRunWaveformTriangle(unit, time, endTime);
+			break;
+		}
+		case BK_NOISE: {
+			time = BKUnitRunWaveformNoise(unit, time, endTime);
+			break;
+		}
+		case BK_SAWTOOTH: {
+			time = BKUnitRunWaveformSawtooth(unit, time, endTime);
+			break;
+		}
+		case BK_SINE: {
+			time = BKUnitRunWaveformSine(unit, time, endTime);
+			break;
+		}
+		case BK_CUSTOM: {
+			time = BKUnitRunWaveformCustom(unit, time, endTime);
+			break;
+		}
+		case BK_WAVETABLE: {
+			time = BKUnitRunWaveformWavetable(unit, time, endTime);
+			break;
+		}
 	}
 
 	return time;
@@ -1063,12 +1452,309 @@ static BKInt BKUnitResetSample(BKUnit* unit) {
 	return halt;
 }
 
+/**
+ * Get number of frames which can be played at the sample rate
+ * until `endTime` or the next sample or sustain range boundary
+ */
+static BKUInt BKUnitSampleBlockSize(BKUnit const* unit, BKFUInt64 time, BKFUInt64 endTime, BKInt checkBounds) {
+	BKUInt size = (BKUInt)((endTime - time + BK_FINT20_UNIT - 1) >> BK_FINT20_SHIFT);
+	BKUInt phase = unit->phase.phase;
+
+	size = phase < unit->sample.length ? BKMin(size, unit->sample.length - phase) : 1;
+
+	if (checkBounds) {
+		size = phase < unit->sample.sustainEnd ? BKMin(size, unit->sample.sustainEnd - phase) : 1;
+	}
+
+	return BKMax(size, 1);
+}
+
+/**
+ * Add `size` sample frames to channels
+ * Frames are added directly as they are aligned to output frames
+ */
+static void BKUnitRunSampleBlock(BKUnit* unit, BKFUInt64 time, BKUInt size) {
+	BKUInt numChannels = unit->sample.numChannels;
+	BKFrame const* frames = &unit->sample.frames[unit->phase.phase * numChannels];
+
+	time += unit->sample.timeFrac;
+
+	for (BKInt i = 0; i < unit->ctx->numChannels; i++) {
+		BKFrame const* channelFrames = &frames[numChannels == 1 ? 0 : i];
+
+		BKBufferAddSteps(&unit->channels[i], time, channelFrames, numChannels, size, unit->volume[i], &unit->lastPulse[i]);
+	}
+
+	unit->phase.phase += size;
+}
+
+/**
+ * Advance sample phase by one output frame
+ */
+BK_INLINE void BKUnitAdvanceSamplePhase(BKUnit* unit) {
+	BKFInt20 lastTime = unit->sample.timeFrac;
+	unit->sample.timeFrac += unit->sample.period; // may be negative
+	unit->phase.phase += (unit->sample.timeFrac >> BK_FINT20_SHIFT) - (lastTime >> BK_FINT20_SHIFT);
+	unit->sample.timeFrac &= BK_FINT20_FRAC;
+}
+
+/**
+ * Frame range which taps of an interpolation kernel wrap around
+ * and tap positions of the widened sinc kernel of the current frame
+ */
+typedef struct {
+	BKInt start;
+	BKInt end;
+	BKEnum repeatMode;
+	BKInt radius;	  // frames on each side of phase; 0 if kernel is not widened
+	BKFUInt20 scale;  // factor the kernel is widened by
+	int64_t tapPos;	  // kernel position of frame `phase - radius` divided by `scale`
+	BKInt tapRem;	  // remainder of `tapPos`
+	BKInt tapStep;	  // kernel position step per frame divided by `scale`
+	BKInt tapStepRem; // remainder of `tapStep`
+} BKUnitSampleTaps;
+
+/**
+ * Get frame range which taps around `phase` wrap around
+ * Taps wrap around the sustain range while playing in it or else around the
+ * sample according to the repeat mode
+ */
+static BKUnitSampleTaps BKUnitGetSampleTaps(BKUnit const* unit, BKInt phase, BKFUInt20 frac) {
+	BKUnitSampleTaps taps = {0, unit->sample.length, BK_NO_REPEAT};
+	BKUInt flags = unit->object.flags;
+
+	if (unit->sample.interpolation == BK_INTERPOLATION_SINC) {
+		BKFUInt20 scale = BKMin(BKAbs(unit->sample.period), BK_SINC_INTERP_MAX_SCALE * BK_FINT20_UNIT);
+
+		// widen kernel when pitched up
+		if (scale > BK_FINT20_UNIT) {
+			taps.radius = (BK_SINC_INTERP_TAPS / 2 * scale) >> BK_FINT20_SHIFT;
+			taps.scale = scale;
+
+			int64_t pos = ((int64_t)-taps.radius * BK_FINT20_UNIT - frac) * BK_FINT20_UNIT;
+			int64_t step = (int64_t)BK_FINT20_UNIT * BK_FINT20_UNIT;
+
+			taps.tapPos = pos / scale;
+			taps.tapRem = (BKInt)(pos % scale);
+			taps.tapStep = (BKInt)(step / scale);
+			taps.tapStepRem = (BKInt)(step % scale);
+
+			// round down
+			if (taps.tapRem < 0) {
+				taps.tapPos--;
+				taps.tapRem += scale;
+			}
+		}
+	}
+
+	if ((flags & BKUnitFlagSampleSustainRange) && !(flags & BKUnitFlagRelease) && phase >= (BKInt)unit->sample.sustainOffset && phase < (BKInt)unit->sample.sustainEnd) {
+		taps.start = unit->sample.sustainOffset;
+		taps.end = unit->sample.sustainEnd;
+		taps.repeatMode = unit->sample.repeatMode == BK_PALINDROME ? BK_PALINDROME : BK_REPEAT;
+	}
+	// repeat is decided by callback
+	else if (!unit->sample.callback.func) {
+		taps.repeatMode = unit->sample.repeatMode;
+	}
+
+	return taps;
+}
+
+/**
+ * Get sample frame of `channel` at `index` wrapped around `taps`
+ */
+BK_INLINE BKInt BKUnitSampleFrame(BKUnit const* unit, BKUnitSampleTaps const* taps, BKInt index, BKInt channel) {
+	if (index < taps->start || index >= taps->end) {
+		BKInt length = taps->end - taps->start;
+		BKInt offset = index - taps->start;
+
+		switch (taps->repeatMode) {
+			case BK_REPEAT: {
+				offset %= length;
+				index = taps->start + (offset < 0 ? offset + length : offset);
+				break;
+			}
+			case BK_PALINDROME: {
+				// frames at both ends are played twice
+				offset %= 2 * length;
+				offset = offset < 0 ? offset + 2 * length : offset;
+				index = taps->start + (offset < length ? offset : 2 * length - 1 - offset);
+				break;
+			}
+			default: {
+				index = BKClamp(index, 0, (BKInt)unit->sample.length - 1);
+				break;
+			}
+		}
+	}
+
+	return unit->sample.frames[index * unit->sample.numChannels + channel];
+}
+
+/**
+ * Interpolate sample with windowed sinc kernel widened by the pitch
+ * Lowers the cutoff frequency to the output's Nyquist frequency when pitched up
+ */
+static BKInt BKUnitInterpolateSampleScaled(BKUnit const* unit, BKUnitSampleTaps const* taps, BKInt phase, BKInt channel) {
+	int64_t x = taps->tapPos;
+	BKInt rem = taps->tapRem;
+	int64_t sum = 0;
+	int64_t weights = 0;
+
+	for (BKInt index = phase - taps->radius; index <= phase + taps->radius + 1; index++) {
+		// kernel position of frame rounded towards the kernel center, shifted to the first tap
+		int64_t pos = x + (x < 0 && rem) + 3 * BK_FINT20_UNIT;
+		int64_t tap = (pos + BK_FINT20_UNIT - 1) >> BK_FINT20_SHIFT;
+
+		// advance position without dividing
+		x += taps->tapStep;
+		rem += taps->tapStepRem;
+
+		if (rem >= (BKInt)taps->scale) {
+			rem -= taps->scale;
+			x++;
+		}
+
+		if (tap < 0 || tap >= BK_SINC_INTERP_TAPS) {
+			continue;
+		}
+
+		BKInt tapPhase = (BKInt)((tap << BK_FINT20_SHIFT) - pos) >> (BK_FINT20_SHIFT - 5);
+		BKInt weight = sincInterpPhases[tapPhase][tap];
+
+		sum += (int64_t)weight * BKUnitSampleFrame(unit, taps, index, channel);
+		weights += weight;
+	}
+
+	// normalize as the widened kernel has more taps
+	return weights ? (BKInt)(sum / weights) : 0;
+}
+
+/**
+ * Interpolate sample frame of `channel` between `phase` and `phase + 1`
+ */
+static BKInt BKUnitInterpolateSample(BKUnit const* unit, BKUnitSampleTaps const* taps, BKInt phase, BKFUInt20 frac, BKInt channel) {
+	BKInt value = 0;
+
+	switch (unit->sample.interpolation) {
+		case BK_INTERPOLATION_LINEAR: {
+			BKInt t = frac >> (BK_FINT20_SHIFT - 14);
+			BKInt a = BKUnitSampleFrame(unit, taps, phase, channel);
+			BKInt b = BKUnitSampleFrame(unit, taps, phase + 1, channel);
+
+			value = a + (((b - a) * t) >> 14);
+			break;
+		}
+		case BK_INTERPOLATION_CUBIC: {
+			int64_t t = frac >> (BK_FINT20_SHIFT - 16);
+			int64_t p0 = BKUnitSampleFrame(unit, taps, phase - 1, channel);
+			int64_t p1 = BKUnitSampleFrame(unit, taps, phase, channel);
+			int64_t p2 = BKUnitSampleFrame(unit, taps, phase + 1, channel);
+			int64_t p3 = BKUnitSampleFrame(unit, taps, phase + 2, channel);
+
+			int64_t a = 3 * (p1 - p2) + p3 - p0;
+			int64_t b = 2 * p0 - 5 * p1 + 4 * p2 - p3;
+			int64_t c = p2 - p0;
+
+			value = (BKInt)(p1 + ((((((a * t) >> 16) + b) * t >> 16) + c) * t >> 17));
+			break;
+		}
+		case BK_INTERPOLATION_SINC: {
+			// pitched up
+			if (taps->radius) {
+				value = BKUnitInterpolateSampleScaled(unit, taps, phase, channel);
+				break;
+			}
+
+			BKFrame const* kernel = sincInterpPhases[frac >> (BK_FINT20_SHIFT - 5)];
+			int64_t sum = 0;
+
+			for (BKInt i = 0; i < BK_SINC_INTERP_TAPS; i++) {
+				sum += (int64_t)kernel[i] * BKUnitSampleFrame(unit, taps, phase - 3 + i, channel);
+			}
+
+			value = (BKInt)(sum >> BK_SINC_INTERP_SHIFT);
+			break;
+		}
+		default: {
+			value = BKUnitSampleFrame(unit, taps, phase, channel);
+			break;
+		}
+	}
+
+	return BKClamp(value, -(BKInt)BK_FRAME_MAX - 1, (BKInt)BK_FRAME_MAX);
+}
+
+/**
+ * Add interpolated sample frame at output frame `time` to channels
+ */
+static void BKUnitRunSampleInterpolated(BKUnit* unit, BKFUInt64 time) {
+	BKInt phase = unit->phase.phase;
+	BKFUInt20 frac = unit->sample.timeFrac;
+	BKUnitSampleTaps taps = BKUnitGetSampleTaps(unit, phase, frac);
+
+	for (BKInt i = 0; i < unit->ctx->numChannels; i++) {
+		BKInt pulse = BKUnitInterpolateSample(unit, &taps, phase, frac, unit->sample.numChannels == 1 ? 0 : i);
+		BKInt delta = (pulse * unit->volume[i]) >> BK_VOLUME_SHIFT;
+
+		BKInt chanDelta = delta - unit->lastPulse[i];
+		unit->lastPulse[i] = delta;
+
+		if (chanDelta) {
+			BKBufferAddStep(&unit->channels[i], time, chanDelta);
+		}
+	}
+}
+
+/**
+ * Reset sample if phase exceeds the sample and wrap phase in sustain range
+ * Returns 1 if the sample has halted
+ */
+static BKInt BKUnitCheckSampleBounds(BKUnit* unit, BKInt checkBounds) {
+	// check phase boundary
+	if ((BKInt)unit->phase.phase < 0 || (BKInt)unit->phase.phase >= (BKInt)unit->sample.length) {
+		if (BKUnitResetSample(unit) == 1) {
+			return 1;
+		}
+	}
+
+	// check for sustain range boundary
+	if (checkBounds) {
+		BKInt reverse = unit->sample.repeatMode == BK_PALINDROME;
+
+		if (unit->sample.period > 0) {
+			if ((BKInt)unit->phase.phase >= (BKInt)unit->sample.sustainEnd) {
+				if (reverse) {
+					unit->phase.phase = unit->sample.sustainEnd - 1;
+					unit->sample.period = -unit->sample.period;
+				}
+				else {
+					unit->phase.phase = unit->sample.sustainOffset;
+				}
+			}
+		}
+		else {
+			if ((BKInt)unit->phase.phase < (BKInt)unit->sample.sustainOffset) {
+				if (reverse) {
+					unit->phase.phase = unit->sample.sustainOffset;
+					unit->sample.period = -unit->sample.period;
+				}
+				else {
+					unit->phase.phase = unit->sample.sustainEnd - 1;
+				}
+			}
+		}
+	}
+
+	return 0;
+}
+
 /**
  * Fills buffer with sample to specified time
  * Calls sample callback if sample has ended and asks if it should be repeated
  */
-static BKFUInt20 BKUnitRunSample(BKUnit* unit, BKFUInt20 endTime) {
-	BKFInt20 time;
+static BKFUInt64 BKUnitRunSample(BKUnit* unit, BKFUInt64 endTime) {
+	BKFUInt64 time;
 
 	// muted
 	if (unit->mute) {
@@ -1083,69 +1769,48 @@ static BKFUInt20 BKUnitRunSample(BKUnit* unit, BKFUInt20 endTime) {
 	BKInt checkBounds = (unit->object.flags & BKUnitFlagSampleSustainRange) && !(unit->object.flags & BKUnitFlagRelease);
 
 	for (time = unit->time; time < endTime; time += BK_FINT20_UNIT) {
-		BKFrame* frames = &unit->sample.frames[unit->phase.phase * unit->sample.numChannels];
-
-		// update each channel
-		for (BKInt i = 0; i < unit->ctx->numChannels; i++) {
-			BKBuffer* channel = &unit->ctx->channels[i];
-			BKInt volume = unit->volume[i];
-			BKInt pulse = frames[unit->sample.numChannels == 1 ? 0 : i];
-			BKInt delta = (pulse * volume) >> BK_VOLUME_SHIFT;
+		// play block until next boundary at sample rate
+		if (unit->sample.period == BK_FINT20_UNIT) {
+			BKUInt size = BKUnitSampleBlockSize(unit, time, endTime, checkBounds);
 
-			BKInt chanDelta = delta - unit->lastPulse[i];
-			unit->lastPulse[i] = delta;
-
-			BKBufferAddPulse(channel, time + unit->sample.timeFrac, chanDelta);
+			BKUnitRunSampleBlock(unit, time, size);
+			time += (BKFUInt64)(size - 1) * BK_FINT20_UNIT;
 		}
+		// resample at output frame
+		else if (unit->sample.interpolation != BK_INTERPOLATION_NONE) {
+			BKUnitRunSampleInterpolated(unit, time);
+			BKUnitAdvanceSamplePhase(unit);
+		}
+		else {
+			BKFrame* frames = &unit->sample.frames[unit->phase.phase * unit->sample.numChannels];
 
-		// advance phase
-		BKFInt20 lastTime = unit->sample.timeFrac;
-		unit->sample.timeFrac += unit->sample.period; // may be negative
-		unit->phase.phase += (unit->sample.timeFrac >> BK_FINT20_SHIFT) - (lastTime >> BK_FINT20_SHIFT);
-		unit->sample.timeFrac &= BK_FINT20_FRAC;
+			// update each channel
+			for (BKInt i = 0; i < unit->ctx->numChannels; i++) {
+				BKBuffer* channel = &unit->channels[i];
+				BKInt volume = unit->volume[i];
+				BKInt pulse = frames[unit->sample.numChannels == 1 ? 0 : i];
+				BKInt delta = (pulse * volume) >> BK_VOLUME_SHIFT;
 
-		// check phase boundary
-		if ((BKInt)unit->phase.phase < 0 || (BKInt)unit->phase.phase >= (BKInt)unit->sample.length) {
-			if (BKUnitResetSample(unit) == 1) {
-				break;
+				BKInt chanDelta = delta - unit->lastPulse[i];
+				unit->lastPulse[i] = delta;
+
+				BKBufferAddPulse(channel, time + unit->sample.timeFrac, chanDelta);
 			}
-		}
 
-		// check for sustain range boundary
-		if (checkBounds) {
-			BKInt reverse = unit->sample.repeatMode == BK_PALINDROME;
+			BKUnitAdvanceSamplePhase(unit);
+		}
 
-			if (unit->sample.period > 0) {
-				if ((BKInt)unit->phase.phase >= (BKInt)unit->sample.sustainEnd) {
-					if (reverse) {
-						unit->phase.phase = unit->sample.sustainEnd - 1;
-						unit->sample.period = -unit->sample.period;
-					}
-					else {
-						unit->phase.phase = unit->sample.sustainOffset;
-					}
-				}
-			}
-			else {
-				if ((BKInt)unit->phase.phase < (BKInt)unit->sample.sustainOffset) {
-					if (reverse) {
-						unit->phase.phase = unit->sample.sustainOffset;
-						unit->sample.period = -unit->sample.period;
-					}
-					else {
-						unit->phase.phase = unit->sample.sustainEnd - 1;
-					}
-				}
-			}
+		if (BKUnitCheckSampleBounds(unit, checkBounds) == 1) {
+			break;
 		}
 	}
 
 	return time;
 }
 
-BKInt BKUnitRun(BKUnit* unit, BKFUInt20 endTime) {
+BKInt BKUnitRun(BKUnit* unit, BKFUInt64 endTime) {
 	BKContext* ctx = unit->ctx;
-	BKFUInt20 time = unit->time;
+	BKFUInt64 time = unit->time;
 
 	if (unit->period) {
 		switch (unit->waveform) {
@@ -1154,7 +1819,8 @@ BKInt BKUnitRun(BKUnit* unit, BKFUInt20 endTime) {
 			case BK_NOISE:
 			case BK_SAWTOOTH:
 			case BK_SINE:
-			case BK_CUSTOM: {
+			case BK_CUSTOM:
+			case BK_WAVETABLE: {
 				time = BKUnitRunWaveform(unit, endTime);
 				break;
 			}
@@ -1172,7 +1838,7 @@ BKInt BKUnitRun(BKUnit* unit, BKFUInt20 endTime) {
 
 	// advance buffer capacity
 	for (BKInt i = 0; i < ctx->numChannels; i++) {
-		BKBuffer* channel = &ctx->channels[i];
+		BKBuffer* channel = &unit->channels[i];
 		BKBufferEnd(channel, time);
 	}
 
@@ -1181,16 +1847,232 @@ BKInt BKUnitRun(BKUnit* unit, BKFUInt20 endTime) {
 	return 0;
 }
 
+BKUInt BKUnitSkipNoise(BKUInt phase, BKFUInt64 steps) {
+	// state repeats after all nonzero values
+	steps %= BK_NOISE_PERIOD;
+
+	for (; steps >= BK_NOISE_TABLE_STEPS; steps -= BK_NOISE_TABLE_STEPS) {
+		BKUInt bits = BKUnitNoiseBits[phase & ((1 << BK_NOISE_TABLE_BITS) - 1)];
+		bits &= (1 << BK_NOISE_TABLE_STEPS) - 1;
+		phase = (phase >> BK_NOISE_TABLE_STEPS) | (bits << (16 - BK_NOISE_TABLE_STEPS));
+	}
+
+	for (; steps; steps--) {
+		BKUInt bit = ((phase >> 0) ^ (phase >> 2) ^ (phase >> 3) ^ (phase >> 5)) & 1;
+		phase = (phase >> 1) | (bit << 15);
+	}
+
+	return phase;
+}
+
+/**
+ * Advance phase wrap counter by `steps` steps
+ * Returns the number of steps after the last wrap including the wrapping step
+ * or `steps` if the phase did not wrap
+ */
+static BKFUInt64 BKUnitSkipWrap(BKUnit* unit, BKFUInt64 steps, BKInt* outWrapped) {
+	BKUInt wrap = unit->phase.wrap;
+	BKFUInt64 count = BKMax(unit->phase.wrapCount, 1);
+
+	*outWrapped = 0;
+
+	if (!wrap) {
+		return steps;
+	}
+
+	if (steps < count) {
+		unit->phase.wrapCount -= (BKInt)steps;
+
+		return steps;
+	}
+
+	steps = (steps - count) % wrap;
+	unit->phase.wrapCount = wrap - (BKInt)steps;
+	*outWrapped = 1;
+
+	return steps + 1;
+}
+
+/**
+ * Advance waveform phase to specified time
+ */
+static BKFUInt64 BKUnitSkipWaveform(BKUnit* unit, BKFUInt64 endTime) {
+	BKUInt phase = unit->phase.phase;
+	BKUInt count = unit->phase.count;
+	BKFUInt64 period = unit->period;
+	BKUInt level = 0;
+	BKInt wrapped;
+
+	// muted or silent on all channels
+	if (BKUnitIsIdle(unit)) {
+		return 0;
+	}
+
+	if (unit->waveform == BK_WAVETABLE) {
+		level = BKUnitWavetableLevel(unit);
+		period <<= level;
+	}
+
+	BKFUInt64 numSteps = BKUnitSkipSteps(period, unit->time, endTime);
+	BKFUInt64 steps = numSteps;
+
+	switch (unit->waveform) {
+		case BK_NOISE: {
+			steps = BKUnitSkipWrap(unit, steps, &wrapped);
+			phase = BKUnitSkipNoise(wrapped || !phase ? BK_NOISE_SEED : phase, steps);
+			break;
+		}
+		case BK_CUSTOM: {
+			steps = BKUnitSkipWrap(unit, steps, &wrapped);
+			phase = (BKUInt)(((wrapped ? 0 : phase) + steps) % count);
+			break;
+		}
+		case BK_WAVETABLE: {
+			BKUInt step = 1 << level;
+			phase = (BKUInt)(((phase & (count - step)) + steps * step) & (count - 1));
+			break;
+		}
+		default: {
+			phase = (BKUInt)((phase + steps) % count);
+			break;
+		}
+	}
+
+	unit->phase.phase = phase;
+
+	return unit->time + numSteps * period;
+}
+
+/**
+ * Get number of frames until `endTime` or until the sample phase
+ * reaches the next sample or sustain range boundary
+ */
+static BKFUInt64 BKUnitSkipSampleSize(BKUnit const* unit, BKFUInt64 time, BKFUInt64 endTime, BKInt checkBounds) {
+	BKFUInt64 size = (endTime - time + BK_FINT20_UNIT - 1) >> BK_FINT20_SHIFT;
+	BKInt phase = unit->phase.phase;
+	BKInt period = unit->sample.period;
+	int64_t frac = unit->sample.timeFrac;
+	int64_t steps;
+
+	if (phase < 0 || phase >= (BKInt)unit->sample.length) {
+		return 1;
+	}
+
+	if (period > 0) {
+		BKInt end = unit->sample.length;
+
+		if (checkBounds) {
+			if (phase >= (BKInt)unit->sample.sustainEnd) {
+				return 1;
+			}
+
+			end = BKMin(end, (BKInt)unit->sample.sustainEnd);
+		}
+
+		// first frame reaching `end`
+		steps = (((int64_t)(end - phase) << BK_FINT20_SHIFT) - frac + period - 1) / period;
+	}
+	else {
+		BKInt offset = 0;
+
+		if (checkBounds) {
+			if (phase < (BKInt)unit->sample.sustainOffset) {
+				return 1;
+			}
+
+			offset = unit->sample.sustainOffset;
+		}
+
+		if (period == 0) {
+			return size;
+		}
+
+		// first frame falling below `offset`
+		steps = (((int64_t)(phase - offset) << BK_FINT20_SHIFT) + frac) / -period + 1;
+	}
+
+	return BKMin(size, (BKFUInt64)steps);
+}
+
+/**
+ * Advance sample phase to specified time
+ * Boundaries are handled at the same frames as when running
+ */
+static BKFUInt64 BKUnitSkipSample(BKUnit* unit, BKFUInt64 endTime) {
+	BKFUInt64 time;
+
+	// muted
+	if (unit->mute) {
+		return endTime;
+	}
+
+	// prevent invalid sample length
+	if (BKAbs((BKInt)unit->sample.end - (BKInt)unit->sample.offset) < 2) {
+		return endTime;
+	}
+
+	BKInt checkBounds = (unit->object.flags & BKUnitFlagSampleSustainRange) && !(unit->object.flags & BKUnitFlagRelease);
+
+	for (time = unit->time; time < endTime;) {
+		BKFUInt64 size = BKUnitSkipSampleSize(unit, time, endTime, checkBounds);
+		int64_t timeFrac = unit->sample.timeFrac + (int64_t)size * unit->sample.period;
+
+		// same as advancing phase `size` times
+		unit->phase.phase += (BKInt)(timeFrac >> BK_FINT20_SHIFT);
+		unit->sample.timeFrac = timeFrac & BK_FINT20_FRAC;
+		time += size << BK_FINT20_SHIFT;
+
+		if (BKUnitCheckSampleBounds(unit, checkBounds) == 1) {
+			return endTime;
+		}
+	}
+
+	return time;
+}
+
+BKInt BKUnitSkip(BKUnit* unit, BKFUInt64 endTime) {
+	BKFUInt64 time = unit->time;
+
+	if (unit->period) {
+		switch (unit->waveform) {
+			case BK_SQUARE:
+			case BK_TRIANGLE:
+			case BK_NOISE:
+			case BK_SAWTOOTH:
+			case BK_SINE:
+			case BK_CUSTOM:
+			case BK_WAVETABLE: {
+				time = BKUnitSkipWaveform(unit, endTime);
+				break;
+			}
+			case BK_SAMPLE: {
+				time = BKUnitSkipSample(unit, endTime);
+				break;
+			}
+		}
+	}
+
+	// advance time in case unit is idle
+	if (time < endTime) {
+		time = endTime;
+	}
+
+	unit->time = time;
+
+	return 0;
+}
+
 /**
  * Shift unit time
  */
-void BKUnitEnd(BKUnit* unit, BKFUInt20 time) {
+void BKUnitEnd(BKUnit* unit, BKFUInt64 time) {
 	unit->time -= time;
 }
 
 void BKUnitClear(BKUnit* unit) {
 	BKUnitSetData(unit, BK_WAVEFORM, NULL);
 	BKUnitSetData(unit, BK_SAMPLE, NULL);
+	BKUnitSetData(unit, BK_WAVETABLE, NULL);
 
 	unit->object.flags &= BKUnitFlagsClearMask;
 	unit->phase.wrap = 0;
@@ -1200,6 +2082,7 @@ void BKUnitClear(BKUnit* unit) {
 	unit->sample.end = 0;
 	unit->sample.repeatMode = 0;
 	unit->sample.repeatCount = 0;
+	unit->sample.interpolation = BK_INTERPOLATION_NONE;
 	unit->sample.sustainOffset = 0;
 	unit->sample.sustainEnd = 0;
 	unit->sample.period = BK_FINT20_UNIT;
@@ -1230,12 +2113,112 @@ void BKUnitReset(BKUnit* unit) {
 	}
 }
 
+BKInt BKUnitSave(BKUnit const* unit, void* outState) {
+	BKUnitState state;
+
+	if (outState) {
+		memset(&state, 0, sizeof(state));
+
+		state.time = unit->time;
+		state.period = unit->period;
+		state.waveform = unit->waveform;
+		state.dutyCycle = unit->dutyCycle;
+		state.mute = unit->mute;
+		state.flags = unit->object.flags & ~BKUnitFlagsClearMask;
+		state.phase = unit->phase.phase;
+		state.phaseWrap = unit->phase.wrap;
+		state.phaseWrapCount = unit->phase.wrapCount;
+		state.phaseCount = unit->phase.count;
+		state.sampleOffset = unit->sample.offset;
+		state.sampleEnd = unit->sample.end;
+		state.sampleRepeatMode = unit->sample.repeatMode;
+		state.sampleInterpolation = unit->sample.interpolation;
+		state.sampleRepeatCount = unit->sample.repeatCount;
+		state.sampleSustainOffset = unit->sample.sustainOffset;
+		state.sampleSustainEnd = unit->sample.sustainEnd;
+		state.sampleTimeFrac = unit->sample.timeFrac;
+		state.samplePeriod = unit->sample.period;
+		state.data = unit->sample.dataState.data;
+
+		memcpy(state.lastPulse, unit->lastPulse, sizeof(state.lastPulse));
+		memcpy(state.volume, unit->volume, sizeof(state.volume));
+
+		// state may not be aligned
+		memcpy(outState, &state, sizeof(state));
+	}
+
+	return sizeof(state);
+}
+
+BKInt BKUnitRestore(BKUnit* unit, void const* inState, BKInt check) {
+	BKUnitState state;
+
+	memcpy(&state, inState, sizeof(state));
+
+	switch (state.waveform) {
+		case 0:
+		case BK_SQUARE:
+		case BK_TRIANGLE:
+		case BK_NOISE:
+		case BK_SAWTOOTH:
+		case BK_SINE: {
+			break;
+		}
+		// data is not copied and has to be the same
+		case BK_CUSTOM:
+		case BK_SAMPLE:
+		case BK_WAVETABLE: {
+			if (unit->waveform != state.waveform || (void const*)unit->sample.dataState.data != state.data) {
+				return BK_INVALID_STATE;
+			}
+			break;
+		}
+		default: {
+			return BK_INVALID_STATE;
+			break;
+		}
+	}
+
+	if (check) {
+		return 0;
+	}
+
+	// detaches data
+	if (unit->waveform != state.waveform) {
+		BKUnitSetAttr(unit, BK_WAVEFORM, state.waveform);
+	}
+
+	unit->time = state.time;
+	unit->period = state.period;
+	unit->dutyCycle = state.dutyCycle;
+	unit->mute = state.mute;
+	unit->object.flags = (unit->object.flags & BKUnitFlagsClearMask) | (state.flags & ~BKUnitFlagsClearMask);
+	unit->phase.phase = state.phase;
+	unit->phase.wrap = state.phaseWrap;
+	unit->phase.wrapCount = state.phaseWrapCount;
+	unit->phase.count = state.phaseCount;
+	unit->sample.offset = state.sampleOffset;
+	unit->sample.end = state.sampleEnd;
+	unit->sample.repeatMode = state.sampleRepeatMode;
+	unit->sample.interpolation = state.sampleInterpolation;
+	unit->sample.repeatCount = state.sampleRepeatCount;
+	unit->sample.sustainOffset = state.sampleSustainOffset;
+	unit->sample.sustainEnd = state.sampleSustainEnd;
+	unit->sample.timeFrac = state.sampleTimeFrac;
+	unit->sample.period = state.samplePeriod;
+
+	memcpy(unit->lastPulse, state.lastPulse, sizeof(state.lastPulse));
+	memcpy(unit->volume, state.volume, sizeof(state.volume));
+
+	return 0;
+}
+
 static BKInt BKUnitSetPtrSize(BKUnit* unit, BKEnum attr, void* ptr, BKSize size) {
 	return BKUnitSetPtr(unit, attr, ptr);
 }
 
-static BKInt BKUnitGetPtrSize(BKUnit* unit, BKEnum attr, void* outPtr, BKSize size) {
-	return BKUnitSetPtr(unit, attr, outPtr);
+static BKInt BKUnitGetPtrSize(BKUnit const* unit, BKEnum attr, void* outPtr, BKSize size) {
+	return BKUnitGetPtr(unit, attr, outPtr);
 }
 
 BKClass BKUnitClass = {
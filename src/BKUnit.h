@@ -31,6 +31,8 @@ enum {
 	BKUnitFlagSampleSustainRange = 1 << 0, // has `BK_SAMPLE_SUSTAIN_RANGE` set
 	BKUnitFlagSampleSustainJump = 1 << 1,  // should jump immediately to release phase
 	BKUnitFlagRelease = 1 << 2,			   // set release phase
+	BKUnitFlagActive = 1 << 3,			   // is in active units of context
+	BKUnitFlagWakePending = 1 << 4,		   // woken while workers were running
 	BKUnitFlagsClearMask = ~7,
 };
 
@@ -43,31 +45,54 @@ typedef struct BKUnitFuncs BKUnitFuncs;
  * All functions return 0 on success and values < 0 on error
  */
 
-typedef BKInt (*BKUnitRunFunc)(void* unit, BKFUInt20 endTime);
-typedef void (*BKUnitEndFunc)(void* unit, BKFUInt20 time);
+/**
+ * Render counters of unit
+ * Only updated when compiled with `BK_USE_PROFILING`
+ */
+typedef struct {
+	uint64_t numRuns;	// calls of `run`
+	uint64_t numPulses; // pulses added to channels
+	uint64_t numFrames; // frames covered by runs
+	uint64_t runTime;	// nanoseconds spent in `run`
+} BKUnitProfile;
+
+typedef BKInt (*BKUnitRunFunc)(void* unit, BKFUInt64 endTime);
+typedef BKInt (*BKUnitSkipFunc)(void* unit, BKFUInt64 endTime);
+typedef void (*BKUnitEndFunc)(void* unit, BKFUInt64 time);
 typedef void (*BKUnitResetFunc)(void* unit);
+typedef BKInt (*BKUnitIdleFunc)(void* unit);
+typedef BKInt (*BKUnitSaveFunc)(void const* unit, void* outState);
+typedef BKInt (*BKUnitRestoreFunc)(void* unit, void const* inState, BKInt check);
 
 struct BKUnit {
 	BKObject object;
 
 	// context
 	BKContext* ctx;
+	BKBuffer* channels; // buffers to render into
 	BKUnitRunFunc run;
+	BKUnitSkipFunc skip;	   // advances like `run` without writing frames
 	BKUnitEndFunc end;
 	BKUnitResetFunc reset;
+	BKUnitIdleFunc idle;	   // checks if run would not write any frames
+	BKUnitSaveFunc save;	   // writes state into `outState` if not NULL and returns its size
+	BKUnitRestoreFunc restore; // sets state or only checks if it can be set
 
 	// linking
 	BKUnit* prevUnit;
 	BKUnit* nextUnit;
+	BKUnit* prevActiveUnit;
+	BKUnit* nextActiveUnit;
 
 	// time
-	BKFUInt20 time;
+	BKFUInt64 time;
 	BKFUInt20 period;
 	BKInt lastPulse[BK_MAX_CHANNELS];
 
 	// waveform
 	BKEnum waveform;
 	BKUInt dutyCycle;
+	unsigned char customEdges[BK_WAVE_MAX_LENGTH]; // steps to next value change of custom waveform
 
 	// volume
 	BKInt volume[BK_MAX_CHANNELS];
@@ -89,6 +114,7 @@ struct BKUnit {
 		BKUInt offset;
 		BKUInt end;
 		BKUInt repeatMode;
+		BKUInt interpolation;
 		BKUInt repeatCount;
 		BKUInt sustainOffset; // relative to `offset`
 		BKUInt sustainEnd;	  // relative to `offset`
@@ -97,6 +123,15 @@ struct BKUnit {
 		BKCallback callback;
 		BKFrame* frames;
 	} sample;
+
+	// wavetable
+	struct {
+		BKFrame* frames; // mipmap levels; level `n` has `phase.count >> n` frames
+		BKUInt numLevels;
+	} wavetable;
+
+	// only updated with `BK_USE_PROFILING`; always present to keep the struct layout
+	BKUnitProfile profile;
 };
 
 /**
@@ -164,6 +199,13 @@ extern void BKUnitDetach(BKUnit* unit);
  * BK_SAMPLE_PERIOD
  *   Set speed at which the sample is played
  *   Default is BK_FINT20_UNIT
+ * BK_SAMPLE_INTERPOLATION
+ *   Set how frames between sample frames are calculated when the sample is pitched:
+ *   `BK_INTERPOLATION_LINEAR`, `BK_INTERPOLATION_CUBIC`, `BK_INTERPOLATION_SINC`
+ *   The sinc kernel is widened when pitched up to filter frequencies above the
+ *   output's Nyquist frequency; up to 3 octaves
+ *   Frames around the end of a repeated sample or sustain range are taken from its start
+ *   Default is `BK_INTERPOLATION_NONE`
  * BK_SAMPLE_SUSTAIN_RANGE
  *   Set range to repeat when sample is played
  *   `BK_SAMPLE_REPEAT` does not affect sustain range
@@ -176,6 +218,9 @@ extern void BKUnitDetach(BKUnit* unit);
  *   Phase does stop cycling when muted or volume is 0
  *   This is automatically set when using BK_TRIANGLE and disabled on other waveforms
  *   It can reduce clicking noise when waveform is similar to triangle or sine
+ * BK_PROFILE
+ *   Reset render counters; value is ignored
+ *   Only available when compiled with `BK_USE_PROFILING`
  *
  * Errors:
  * BK_INVALID_ATTRIBUTE if attribute is unknown
@@ -198,6 +243,7 @@ extern BKInt BKUnitSetAttr(BKUnit* unit, BKEnum attr, BKInt value);
  * BK_MUTE
  * BK_SAMPLE_REPEAT
  * BK_SAMPLE_PERIOD
+ * BK_SAMPLE_INTERPOLATION
  *
  * Errors:
  * BK_INVALID_ATTRIBUTE if attribute is unknown
@@ -217,6 +263,11 @@ extern BKInt BKUnitGetAttr(BKUnit const* unit, BKEnum attr, BKInt* outValue);
  *   Set sample to play via a `BKData` object. Sample is only played once.
  *   If it should be repeated set attribute `BK_SAMPLE_REPEAT` to a value greater 1 or
  *   set `BK_SAMPLE_CALLBACK`
+ * BK_WAVETABLE
+ *   Set single-cycle wavetable via a `BKData` object. Only the first channel is used
+ *   The table is resampled to a power of 2 of at most `BK_WAVETABLE_MAX_LENGTH` frames
+ *   and reduced to band-limited mipmaps; the level is chosen from `BK_PERIOD`
+ *   so that no more than one step is played per frame
  * BK_SAMPLE_RANGE
  *   Set sample repeat range as BKInt[2]
  *   The first value defines the start offset in frames
@@ -236,9 +287,13 @@ extern BKInt BKUnitSetPtr(BKUnit* unit, BKEnum attr, void* ptr);
  * BK_SAMPLE_CALLBACK
  *   Get sample callback
  * BK_SAMPLE
- *   Get `BKData` object if waveform is BK_CUSTOM or BK_SAMPLE
+ *   Get `BKData` object if waveform is BK_CUSTOM, BK_SAMPLE or BK_WAVETABLE
  * BK_SAMPLE_RANGE
  *  Get sample repeat range
+ * BK_PROFILE
+ *   Get render counters
+ *   Only available when compiled with `BK_USE_PROFILING`
+ *   ptrRef = `BKUnitProfile`
  *
  * Errors:
  * BK_INVALID_ATTRIBUTE if attribute is unknown
@@ -0,0 +1,752 @@
+/*
+ * Copyright (c) 2012-2015 Simon Schoenenberger
+ * http://blipkit.audio
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "BKUnitBank.h"
+#include "BKAllocator.h"
+#include "BKContext_internal.h"
+#include "BKUnit_internal.h"
+
+extern BKClass BKUnitBankClass;
+
+static BKInt BKUnitBankRun(BKUnitBank* bank, BKFUInt64 endTime);
+static BKInt BKUnitBankSkip(BKUnitBank* bank, BKFUInt64 endTime);
+static void BKUnitBankEnd(BKUnitBank* bank, BKFUInt64 time);
+static void BKUnitBankReset(BKUnitBank* bank);
+static BKInt BKUnitBankSave(BKUnitBank const* bank, void* outState);
+static BKInt BKUnitBankRestore(BKUnitBank* bank, void const* inState, BKInt check);
+
+/**
+ * Size of all voice values of a single voice
+ */
+#define BK_UNIT_BANK_VOICE_SIZE (sizeof(BKFUInt64) + sizeof(BKFUInt20) + sizeof(BKUInt) + sizeof(BKEnum) + sizeof(BKUInt) + sizeof(BKInt) + 2 * BK_MAX_CHANNELS * sizeof(BKInt))
+
+/**
+ * Allocate voice arrays in a single block
+ * Voice order and scratch indices follow the voice values
+ */
+static BKInt BKUnitBankAllocVoices(BKUnitBank* bank, BKUInt numVoices) {
+	char* block = BKMemCalloc(numVoices, BK_UNIT_BANK_VOICE_SIZE + 2 * sizeof(BKUInt));
+
+	if (!block) {
+		return BK_ALLOCATION_ERROR;
+	}
+
+	// 64 bit values first to keep alignment
+	bank->time = (BKFUInt64*)block;
+	block += numVoices * sizeof(BKFUInt64);
+	bank->period = (BKFUInt20*)block;
+	block += numVoices * sizeof(BKFUInt20);
+	bank->phase = (BKUInt*)block;
+	block += numVoices * sizeof(BKUInt);
+	bank->waveform = (BKEnum*)block;
+	block += numVoices * sizeof(BKEnum);
+	bank->dutyCycle = (BKUInt*)block;
+	block += numVoices * sizeof(BKUInt);
+	bank->mute = (BKInt*)block;
+	block += numVoices * sizeof(BKInt);
+
+	for (BKInt i = 0; i < BK_MAX_CHANNELS; i++) {
+		bank->volume[i] = (BKInt*)block;
+		block += numVoices * sizeof(BKInt);
+		bank->lastPulse[i] = (BKInt*)block;
+		block += numVoices * sizeof(BKInt);
+	}
+
+	bank->order = (BKUInt*)block;
+	bank->numVoices = numVoices;
+
+	for (BKUInt voice = 0; voice < numVoices; voice++) {
+		bank->waveform[voice] = BK_SQUARE;
+		bank->dutyCycle[voice] = BK_DEFAULT_DUTY_CYCLE;
+		bank->order[voice] = voice;
+	}
+
+	return 0;
+}
+
+static BKInt BKUnitBankInitGeneric(BKUnitBank* bank, BKUInt numVoices) {
+	BKInt ret;
+
+	if (numVoices == 0) {
+		return BK_INVALID_VALUE;
+	}
+
+	ret = BKUnitInit(&bank->unit, BK_SQUARE);
+
+	if (ret < 0) {
+		return ret;
+	}
+
+	bank->unit.object.isa = &BKUnitBankClass;
+	bank->unit.run = (BKUnitRunFunc)BKUnitBankRun;
+	bank->unit.skip = (BKUnitSkipFunc)BKUnitBankSkip;
+	bank->unit.end = (BKUnitEndFunc)BKUnitBankEnd;
+	bank->unit.reset = (BKUnitResetFunc)BKUnitBankReset;
+	bank->unit.idle = (BKUnitIdleFunc)BKUnitBankIsIdle;
+	bank->unit.save = (BKUnitSaveFunc)BKUnitBankSave;
+	bank->unit.restore = (BKUnitRestoreFunc)BKUnitBankRestore;
+
+	return BKUnitBankAllocVoices(bank, numVoices);
+}
+
+BKInt BKUnitBankInit(BKUnitBank* bank, BKUInt numVoices) {
+	BKInt ret;
+
+	if (BKObjectInit(bank, &BKUnitBankClass, sizeof(*bank)) < 0) {
+		return -1;
+	}
+
+	ret = BKUnitBankInitGeneric(bank, numVoices);
+
+	if (ret < 0) {
+		return ret;
+	}
+
+	return 0;
+}
+
+BKInt BKUnitBankAlloc(BKUnitBank** outBank, BKUInt numVoices) {
+	BKInt ret;
+
+	if (BKObjectAlloc((void**)outBank, &BKUnitBankClass, 0) < 0) {
+		return -1;
+	}
+
+	BKUInt flags = (*outBank)->unit.object.flags & BKObjectFlagMask;
+
+	ret = BKUnitBankInitGeneric(*outBank, numVoices);
+
+	// cleared by `BKUnitInit`
+	(*outBank)->unit.object.flags |= flags;
+
+	if (ret < 0) {
+		BKDispose(*outBank);
+		*outBank = NULL;
+		return ret;
+	}
+
+	return 0;
+}
+
+static void BKUnitBankDisposeObject(BKUnitBank* bank) {
+	BKUnitBankDetach(bank);
+	BKUnitDisposeObject(&bank->unit);
+
+	BKMemFree(bank->time);
+}
+
+/**
+ * Shift voice times to unit time
+ */
+static void BKUnitBankSyncTime(BKUnitBank* bank) {
+	for (BKUInt voice = 0; voice < bank->numVoices; voice++) {
+		bank->time[voice] = bank->unit.time;
+	}
+}
+
+BKInt BKUnitBankAttach(BKUnitBank* bank, BKContext* ctx) {
+	BKInt ret = BKUnitAttach(&bank->unit, ctx);
+
+	if (ret == 0) {
+		BKUnitBankSyncTime(bank);
+	}
+
+	return ret;
+}
+
+void BKUnitBankDetach(BKUnitBank* bank) {
+	BKUnitDetach(&bank->unit);
+}
+
+/**
+ * Add sleeping bank to active units if a voice is audible
+ */
+static void BKUnitBankUpdateActive(BKUnitBank* bank) {
+	BKUnit* unit = &bank->unit;
+
+	if (unit->ctx && !(unit->object.flags & BKUnitFlagActive) && !BKUnitBankIsIdle(bank)) {
+		BKContextWakeUnit(unit->ctx, unit);
+		BKUnitBankSyncTime(bank);
+	}
+}
+
+BKInt BKUnitBankSetVoiceAttr(BKUnitBank* bank, BKUInt voice, BKEnum attr, BKInt value) {
+	if (voice >= bank->numVoices) {
+		return BK_INVALID_VALUE;
+	}
+
+	switch (attr) {
+		case BK_WAVEFORM: {
+			switch (value) {
+				case BK_SQUARE:
+				case BK_TRIANGLE:
+				case BK_NOISE:
+				case BK_SAWTOOTH:
+				case BK_SINE: {
+					break;
+				}
+				default: {
+					return BK_INVALID_VALUE;
+					break;
+				}
+			}
+
+			if (bank->waveform[voice] != value) {
+				bank->phase[voice] = 0;
+				bank->waveform[voice] = value;
+			}
+
+			break;
+		}
+		case BK_DUTY_CYCLE: {
+			value = BKClamp(value, BK_MIN_DUTY_CYCLE, BK_MAX_DUTY_CYCLE);
+
+			if (bank->dutyCycle[voice] != value) {
+				if (bank->waveform[voice] == BK_SQUARE) {
+					// reduce clicking noise
+					if (value > bank->dutyCycle[voice] && bank->phase[voice] < value) {
+						bank->phase[voice] = 0;
+					}
+				}
+
+				bank->dutyCycle[voice] = value;
+			}
+
+			break;
+		}
+		case BK_PERIOD: {
+			value = BKMax(BKAbs(value), BK_MIN_PERIOD);
+			bank->period[voice] = value;
+			break;
+		}
+		case BK_PHASE: {
+			BKInt count = BK_SQUARE_PHASES;
+
+			switch (bank->waveform[voice]) {
+				case BK_TRIANGLE: {
+					count = BK_TRIANGLE_PHASES;
+					break;
+				}
+				case BK_NOISE: {
+					count = BK_NOISE_PHASES;
+					break;
+				}
+				case BK_SAWTOOTH: {
+					count = BK_SAWTOOTH_PHASES;
+					break;
+				}
+				case BK_SINE: {
+					count = BK_SINE_PHASES;
+					break;
+				}
+			}
+
+			bank->phase[voice] = BKClamp(value, 0, count - 1);
+			break;
+		}
+		case BK_VOLUME: {
+			value = BKClamp(value, 0, BK_MAX_VOLUME);
+
+			for (BKInt i = 0; i < BK_MAX_CHANNELS; i++) {
+				bank->volume[i][voice] = value;
+			}
+
+			break;
+		}
+		case BK_VOLUME_0:
+		case BK_VOLUME_1:
+		case BK_VOLUME_2:
+		case BK_VOLUME_3:
+		case BK_VOLUME_4:
+		case BK_VOLUME_5:
+		case BK_VOLUME_6:
+		case BK_VOLUME_7: {
+			value = BKClamp(value, 0, BK_MAX_VOLUME);
+			bank->volume[attr - BK_VOLUME_0][voice] = value;
+			break;
+		}
+		case BK_MUTE: {
+			bank->mute[voice] = value ? 1 : 0;
+			break;
+		}
+		default: {
+			return BK_INVALID_ATTRIBUTE;
+			break;
+		}
+	}
+
+	BKUnitBankUpdateActive(bank);
+
+	return 0;
+}
+
+BKInt BKUnitBankGetVoiceAttr(BKUnitBank const* bank, BKUInt voice, BKEnum attr, BKInt* outValue) {
+	BKInt value = 0;
+
+	if (voice >= bank->numVoices) {
+		return BK_INVALID_VALUE;
+	}
+
+	switch (attr) {
+		case BK_WAVEFORM: {
+			value = bank->waveform[voice];
+			break;
+		}
+		case BK_DUTY_CYCLE: {
+			value = bank->dutyCycle[voice];
+			break;
+		}
+		case BK_PERIOD: {
+			value = bank->period[voice];
+			break;
+		}
+		case BK_PHASE: {
+			value = bank->phase[voice];
+			break;
+		}
+		case BK_VOLUME_0:
+		case BK_VOLUME_1:
+		case BK_VOLUME_2:
+		case BK_VOLUME_3:
+		case BK_VOLUME_4:
+		case BK_VOLUME_5:
+		case BK_VOLUME_6:
+		case BK_VOLUME_7: {
+			value = bank->volume[attr - BK_VOLUME_0][voice];
+			break;
+		}
+		case BK_MUTE: {
+			value = bank->mute[voice];
+			break;
+		}
+		default: {
+			return BK_INVALID_ATTRIBUTE;
+			break;
+		}
+	}
+
+	*outValue = value;
+
+	return 0;
+}
+
+/**
+ * Check if voice would write any frames
+ */
+static BKInt BKUnitBankVoiceIsAudible(BKUnitBank const* bank, BKUInt voice, BKInt numChannels) {
+	if (!bank->period[voice] || bank->mute[voice]) {
+		return 0;
+	}
+
+	for (BKInt i = 0; i < numChannels; i++) {
+		if (bank->volume[i][voice]) {
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+BKInt BKUnitBankIsIdle(BKUnitBank const* bank) {
+	BKInt numChannels = bank->unit.ctx ? bank->unit.ctx->numChannels : BK_MAX_CHANNELS;
+
+	for (BKUInt voice = 0; voice < bank->numVoices; voice++) {
+		if (BKUnitBankVoiceIsAudible(bank, voice, numChannels)) {
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+/**
+ * Add scaled pulse of voice to all channels with nonzero volume
+ */
+static void BKUnitBankAddPulses(BKUnitBank* bank, BKUInt voice, BKFUInt64 time, BKInt pulse) {
+	BKInt numChannels = bank->unit.ctx->numChannels;
+	BKFrame pulses[BK_MAX_CHANNELS];
+	BKInt changed = 0;
+
+	for (BKInt i = 0; i < numChannels; i++) {
+		BKInt volume = bank->volume[i][voice];
+		BKInt chanDelta = 0;
+
+		if (volume) {
+			BKInt delta = (pulse * volume) >> BK_VOLUME_SHIFT;
+
+			chanDelta = delta - bank->lastPulse[i][voice];
+			bank->lastPulse[i][voice] = delta;
+		}
+
+		pulses[i] = chanDelta;
+		changed |= chanDelta;
+	}
+
+	if (changed) {
+		BKBufferAddPulses(bank->unit.channels, numChannels, time, pulses);
+	}
+}
+
+/**
+ * Add pulses of voice for `steps` steps with `period` starting at `time`
+ * Only reads the voice phase; noise voices also set their state
+ */
+static void BKUnitBankEmitPulses(BKUnitBank* bank, BKUInt voice, BKFUInt64 time, BKFUInt20 period, BKUInt steps) {
+	BKUInt phase = bank->phase[voice];
+
+	switch (bank->waveform[voice]) {
+		case BK_SQUARE: {
+			BKUInt dutyCycle = bank->dutyCycle[voice];
+
+			phase &= BK_SQUARE_PHASES - 1;
+
+			// jump from edge to edge
+			for (BKUInt step = 0; step < steps;) {
+				BKUnitBankAddPulses(bank, voice, time + (BKFUInt64)step * period, BKUnitSquarePhases[dutyCycle][phase]);
+
+				BKUInt edge = BKMin(BKUnitSquareEdges[dutyCycle][phase], steps - step);
+				phase = (phase + edge) & (BK_SQUARE_PHASES - 1);
+				step += edge;
+			}
+
+			break;
+		}
+		case BK_TRIANGLE: {
+			for (BKUInt step = 0; step < steps; step++) {
+				BKUnitBankAddPulses(bank, voice, time + (BKFUInt64)step * period, BKUnitTrianglePhases[phase]);
+				phase = (phase + 1) & (BK_TRIANGLE_PHASES - 1);
+			}
+
+			break;
+		}
+		case BK_NOISE: {
+			BKInt first = 1;
+
+			// must not be 0
+			if (!phase) {
+				phase = BK_NOISE_SEED;
+			}
+
+			// only add pulse when output changes
+			for (BKUInt step = 0; step < steps;) {
+				BKUInt bits = BKUnitNoiseBits[phase & ((1 << BK_NOISE_TABLE_BITS) - 1)];
+				BKUInt last = phase >> 15; // previous output
+				BKUInt count = BKMin(BK_NOISE_TABLE_STEPS, steps - step);
+
+				for (BKUInt i = 0; i < count; i++) {
+					BKUInt bit = (bits >> i) & 1;
+
+					if (bit != last || first) {
+						BKUnitBankAddPulses(bank, voice, time + (BKFUInt64)(step + i) * period, bit ? BK_MAX_VOLUME / 2 : -BK_MAX_VOLUME / 2);
+						first = 0;
+					}
+
+					last = bit;
+				}
+
+				bits &= (1 << count) - 1;
+				phase = (phase >> count) | (bits << (16 - count));
+				step += count;
+			}
+
+			// state is not advanced with the group
+			bank->phase[voice] = phase;
+			break;
+		}
+		case BK_SAWTOOTH: {
+			for (BKUInt step = 0; step < steps; step++) {
+				BKUnitBankAddPulses(bank, voice, time + (BKFUInt64)step * period, BKUnitSawtoothPhases[phase]);
+
+				if (++phase >= BK_SAWTOOTH_PHASES) {
+					phase = 0;
+				}
+			}
+
+			break;
+		}
+		case BK_SINE: {
+			for (BKUInt step = 0; step < steps; step++) {
+				BKUnitBankAddPulses(bank, voice, time + (BKFUInt64)step * period, BKUnitSinePhases[phase] / 2);
+				phase = (phase + 1) & (BK_SINE_PHASES - 1);
+			}
+
+			break;
+		}
+	}
+}
+
+/**
+ * Check if voice `a` is ordered before voice `b`
+ * Voices are ordered by waveform, period and time
+ */
+BK_INLINE BKInt BKUnitBankVoiceIsBefore(BKUnitBank const* bank, BKUInt a, BKUInt b) {
+	if (bank->waveform[a] != bank->waveform[b]) {
+		return bank->waveform[a] < bank->waveform[b];
+	}
+
+	if (bank->period[a] != bank->period[b]) {
+		return bank->period[a] < bank->period[b];
+	}
+
+	return bank->time[a] < bank->time[b];
+}
+
+/**
+ * Sort voices so that voices with the same waveform, period and time follow each other
+ * Voices are mostly sorted from the last run
+ */
+static void BKUnitBankSortVoices(BKUnitBank* bank) {
+	BKUInt* order = bank->order;
+
+	for (BKUInt i = 1; i < bank->numVoices; i++) {
+		BKUInt voice = order[i];
+		BKUInt j = i;
+
+		for (; j > 0 && BKUnitBankVoiceIsBefore(bank, voice, order[j - 1]); j--) {
+			order[j] = order[j - 1];
+		}
+
+		order[j] = voice;
+	}
+}
+
+/**
+ * Advance phase of group voices by `steps` steps
+ */
+static void BKUnitBankAdvancePhases(BKUnitBank* bank, BKUInt const voices[], BKUInt numVoices, BKEnum waveform, BKFUInt64 steps) {
+	BKUInt* phases = bank->phase;
+
+	switch (waveform) {
+		case BK_SQUARE: {
+			BKUInt delta = (BKUInt)(steps & (BK_SQUARE_PHASES - 1));
+
+			for (BKUInt i = 0; i < numVoices; i++) {
+				phases[voices[i]] = (phases[voices[i]] + delta) & (BK_SQUARE_PHASES - 1);
+			}
+
+			break;
+		}
+		case BK_TRIANGLE: {
+			BKUInt delta = (BKUInt)(steps & (BK_TRIANGLE_PHASES - 1));
+
+			for (BKUInt i = 0; i < numVoices; i++) {
+				phases[voices[i]] = (phases[voices[i]] + delta) & (BK_TRIANGLE_PHASES - 1);
+			}
+
+			break;
+		}
+		case BK_NOISE: {
+			for (BKUInt i = 0; i < numVoices; i++) {
+				BKUInt phase = phases[voices[i]];
+				phases[voices[i]] = BKUnitSkipNoise(phase ? phase : BK_NOISE_SEED, steps);
+			}
+
+			break;
+		}
+		case BK_SAWTOOTH: {
+			BKUInt delta = (BKUInt)(steps % BK_SAWTOOTH_PHASES);
+
+			for (BKUInt i = 0; i < numVoices; i++) {
+				phases[voices[i]] = (phases[voices[i]] + delta) % BK_SAWTOOTH_PHASES;
+			}
+
+			break;
+		}
+		case BK_SINE: {
+			BKUInt delta = (BKUInt)(steps & (BK_SINE_PHASES - 1));
+
+			for (BKUInt i = 0; i < numVoices; i++) {
+				phases[voices[i]] = (phases[voices[i]] + delta) & (BK_SINE_PHASES - 1);
+			}
+
+			break;
+		}
+	}
+}
+
+/**
+ * Advance voices sharing waveform, period and time to `endTime`
+ * The number of steps, phases and times are advanced together; only audible
+ * voices add pulses if `emit` is set
+ * Returns the time after the last step
+ */
+static BKFUInt64 BKUnitBankRunGroup(BKUnitBank* bank, BKUInt const voices[], BKUInt numVoices, BKFUInt64 endTime, BKInt emit) {
+	BKInt numChannels = bank->unit.ctx->numChannels;
+	BKEnum waveform = bank->waveform[voices[0]];
+	BKFUInt20 period = bank->period[voices[0]];
+	BKFUInt64 time = bank->time[voices[0]];
+	BKUInt* audible = &bank->order[bank->numVoices]; // scratch after voice order
+	BKUInt numAudible = 0;
+
+	for (BKUInt i = 0; i < numVoices; i++) {
+		if (BKUnitBankVoiceIsAudible(bank, voices[i], numChannels)) {
+			audible[numAudible++] = voices[i];
+		}
+	}
+
+	// silent voices keep their phase
+	if (!numAudible) {
+		time = BKMax(time, endTime);
+
+		for (BKUInt i = 0; i < numVoices; i++) {
+			bank->time[voices[i]] = time;
+		}
+
+		return time;
+	}
+
+	BKFUInt64 steps = BKUnitSkipSteps(period, time, endTime);
+
+	if (emit) {
+		for (BKUInt i = 0; i < numAudible; i++) {
+			BKUnitBankEmitPulses(bank, audible[i], time, period, (BKUInt)steps);
+		}
+	}
+
+	// noise voices have advanced while emitting pulses
+	if (!emit || waveform != BK_NOISE) {
+		BKUnitBankAdvancePhases(bank, audible, numAudible, waveform, steps);
+	}
+
+	BKFUInt64 nextTime = time + steps * period;
+	BKFUInt64 silentTime = BKMax(time, endTime);
+
+	for (BKUInt i = 0; i < numVoices; i++) {
+		bank->time[voices[i]] = silentTime;
+	}
+
+	for (BKUInt i = 0; i < numAudible; i++) {
+		bank->time[audible[i]] = nextTime;
+	}
+
+	return nextTime;
+}
+
+/**
+ * Advance all voices to `endTime`
+ * Returns the greatest voice time
+ */
+static BKFUInt64 BKUnitBankRunVoices(BKUnitBank* bank, BKFUInt64 endTime, BKInt emit) {
+	BKUInt const* order = bank->order;
+	BKFUInt64 maxTime = endTime;
+
+	BKUnitBankSortVoices(bank);
+
+	for (BKUInt i = 0; i < bank->numVoices;) {
+		BKUInt first = order[i];
+		BKUInt count = 1;
+
+		// group voices which step at the same times
+		while (i + count < bank->numVoices && !BKUnitBankVoiceIsBefore(bank, first, order[i + count])) {
+			count++;
+		}
+
+		maxTime = BKMax(maxTime, BKUnitBankRunGroup(bank, &order[i], count, endTime, emit));
+		i += count;
+	}
+
+	return maxTime;
+}
+
+static BKInt BKUnitBankRun(BKUnitBank* bank, BKFUInt64 endTime) {
+	BKContext* ctx = bank->unit.ctx;
+	BKFUInt64 time = BKUnitBankRunVoices(bank, endTime, 1);
+
+	// advance buffer capacity
+	for (BKInt i = 0; i < ctx->numChannels; i++) {
+		BKBuffer* channel = &bank->unit.channels[i];
+		BKBufferEnd(channel, time);
+	}
+
+	bank->unit.time = time;
+
+	return 0;
+}
+
+/**
+ * Advance voice phases to specified time without writing frames
+ * Voices continue from silence
+ */
+static BKInt BKUnitBankSkip(BKUnitBank* bank, BKFUInt64 endTime) {
+	bank->unit.time = BKUnitBankRunVoices(bank, endTime, 0);
+
+	for (BKInt i = 0; i < BK_MAX_CHANNELS; i++) {
+		memset(bank->lastPulse[i], 0, bank->numVoices * sizeof(BKInt));
+	}
+
+	return 0;
+}
+
+/**
+ * Shift unit and voice times
+ */
+static void BKUnitBankEnd(BKUnitBank* bank, BKFUInt64 time) {
+	for (BKUInt voice = 0; voice < bank->numVoices; voice++) {
+		bank->time[voice] -= time;
+	}
+
+	bank->unit.time -= time;
+}
+
+static void BKUnitBankReset(BKUnitBank* bank) {
+	bank->unit.time = 0;
+
+	for (BKUInt voice = 0; voice < bank->numVoices; voice++) {
+		bank->time[voice] = 0;
+		bank->phase[voice] = 0;
+
+		for (BKInt i = 0; i < BK_MAX_CHANNELS; i++) {
+			bank->lastPulse[i][voice] = 0;
+		}
+	}
+}
+
+static BKInt BKUnitBankSave(BKUnitBank const* bank, void* outState) {
+	BKInt size = BKUnitSave(&bank->unit, outState);
+	BKSize voicesSize = bank->numVoices * BK_UNIT_BANK_VOICE_SIZE;
+
+	// voice values are stored in a single block
+	if (outState) {
+		memcpy((char*)outState + size, bank->time, voicesSize);
+	}
+
+	return size + (BKInt)voicesSize;
+}
+
+static BKInt BKUnitBankRestore(BKUnitBank* bank, void const* inState, BKInt check) {
+	BKInt size = BKUnitSave(&bank->unit, NULL);
+	BKInt res = BKUnitRestore(&bank->unit, inState, check);
+
+	if (res < 0 || check) {
+		return res;
+	}
+
+	memcpy(bank->time, (char const*)inState + size, bank->numVoices * BK_UNIT_BANK_VOICE_SIZE);
+
+	return 0;
+}
+
+BKClass BKUnitBankClass = {
+	.instanceSize = sizeof(BKUnitBank),
+	.dispose = (BKDisposeFunc)BKUnitBankDisposeObject,
+};
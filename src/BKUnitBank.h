@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2012-2015 Simon Schoenenberger
+ * http://blipkit.audio
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef _BK_UNIT_BANK_H_
+#define _BK_UNIT_BANK_H_
+
+#include "BKUnit.h"
+
+typedef struct BKUnitBank BKUnitBank;
+
+/**
+ * A bank renders many voices as a single unit
+ *
+ * Voice values are stored in parallel arrays indexed by voice number.
+ * Voices with the same waveform and period which were started at the same
+ * time step together; their step count, phases and times are advanced at
+ * once and only pulses are added per voice. Supported waveforms are
+ * `BK_SQUARE`, `BK_TRIANGLE`, `BK_NOISE`, `BK_SAWTOOTH` and `BK_SINE`.
+ *
+ * All functions return 0 on success and values < 0 on error
+ */
+struct BKUnitBank {
+	BKUnit unit;
+	BKUInt numVoices;
+
+	// voices
+	BKFUInt64* time;
+	BKFUInt20* period;
+	BKUInt* phase;
+	BKEnum* waveform;
+	BKUInt* dutyCycle;
+	BKInt* mute;
+	BKInt* volume[BK_MAX_CHANNELS];
+	BKInt* lastPulse[BK_MAX_CHANNELS];
+	BKUInt* order; // voices sorted by waveform, period and time
+};
+
+/**
+ * Initialize bank with `numVoices` silent square voices
+ *
+ * Disposing with `BKDispose` detaches the object from the context
+ *
+ * Errors:
+ * BK_INVALID_VALUE if `numVoices` is 0
+ * BK_ALLOCATION_ERROR if voices could not be allocated
+ */
+extern BKInt BKUnitBankInit(BKUnitBank* bank, BKUInt numVoices);
+
+/**
+ * Allocate bank
+ */
+extern BKInt BKUnitBankAlloc(BKUnitBank** outBank, BKUInt numVoices);
+
+/**
+ * Attach to context
+ *
+ * Errors:
+ * BK_INVALID_STATE if already attached to a context
+ */
+extern BKInt BKUnitBankAttach(BKUnitBank* bank, BKContext* ctx);
+
+/**
+ * Detach from context
+ */
+extern void BKUnitBankDetach(BKUnitBank* bank);
+
+/**
+ * Set attribute of voice
+ *
+ * BK_WAVEFORM
+ * BK_DUTY_CYCLE
+ * BK_PERIOD
+ * BK_PHASE
+ * BK_VOLUME
+ * BK_VOLUME_0 ... BK_VOLUME_7
+ * BK_MUTE
+ *
+ * Errors:
+ * BK_INVALID_VALUE if `voice` is out of range or waveform is not supported
+ * BK_INVALID_ATTRIBUTE if attribute is unknown
+ */
+extern BKInt BKUnitBankSetVoiceAttr(BKUnitBank* bank, BKUInt voice, BKEnum attr, BKInt value);
+
+/**
+ * Get attribute of voice
+ *
+ * Errors:
+ * BK_INVALID_VALUE if `voice` is out of range
+ * BK_INVALID_ATTRIBUTE if attribute is unknown
+ */
+extern BKInt BKUnitBankGetVoiceAttr(BKUnitBank const* bank, BKUInt voice, BKEnum attr, BKInt* outValue);
+
+/**
+ * Check if no voice is audible
+ */
+extern BKInt BKUnitBankIsIdle(BKUnitBank const* bank);
+
+#endif /* ! _BK_UNIT_BANK_H_ */
@@ -26,13 +26,82 @@
 
 #include "BKUnit.h"
 
+#define BK_NOISE_TABLE_BITS 9  // state bits needed to get the next output bits
+#define BK_NOISE_TABLE_STEPS 4 // output bits per table entry
+#define BK_NOISE_SEED 0x4a41   // noise state at start and after phase wrap
+#define BK_NOISE_PERIOD 0xFFFF // steps until noise state repeats
+
+typedef struct BKUnitState BKUnitState;
+
+/**
+ * Unit values changed by rendering and attributes
+ * Data is referenced by its address and is not copied
+ */
+struct BKUnitState {
+	BKFUInt64 time;
+	BKFUInt20 period;
+	BKInt lastPulse[BK_MAX_CHANNELS];
+	BKEnum waveform;
+	BKUInt dutyCycle;
+	BKInt volume[BK_MAX_CHANNELS];
+	BKInt mute;
+	BKUInt flags;
+	BKUInt phase;
+	BKUInt phaseWrap;
+	BKInt phaseWrapCount;
+	BKUInt phaseCount;
+	BKUInt sampleOffset;
+	BKUInt sampleEnd;
+	BKUInt sampleRepeatMode;
+	BKUInt sampleInterpolation;
+	BKUInt sampleRepeatCount;
+	BKUInt sampleSustainOffset;
+	BKUInt sampleSustainEnd;
+	BKFInt20 sampleTimeFrac;
+	BKFInt20 samplePeriod;
+	void const* data; // only compared
+};
+
+/**
+ * Waveform phases shared with `BKUnitBank`
+ */
+extern BKFrame const BKUnitSquarePhases[BK_SQUARE_PHASES + 1][BK_SQUARE_PHASES];
+extern unsigned char const BKUnitSquareEdges[BK_SQUARE_PHASES + 1][BK_SQUARE_PHASES];
+extern BKFrame const BKUnitTrianglePhases[BK_TRIANGLE_PHASES];
+extern unsigned char const BKUnitNoiseBits[1 << BK_NOISE_TABLE_BITS];
+extern BKFrame const BKUnitSawtoothPhases[BK_SAWTOOTH_PHASES];
+extern BKFrame const BKUnitSinePhases[BK_SINE_PHASES];
+
+/**
+ * Get number of steps with `period` needed to reach `endTime`
+ */
+BK_INLINE BKFUInt64 BKUnitSkipSteps(BKFUInt64 period, BKFUInt64 time, BKFUInt64 endTime) {
+	return time < endTime ? (endTime - time + period - 1) / period : 0;
+}
+
+/**
+ * Advance noise state `phase` by `steps` steps
+ */
+extern BKUInt BKUnitSkipNoise(BKUInt phase, BKFUInt64 steps);
+
 /*
  */
-extern BKInt BKUnitRun(BKUnit* unit, BKFUInt20 endTime);
+extern BKInt BKUnitRun(BKUnit* unit, BKFUInt64 endTime);
+
+/**
+ * Advance phase and time to `endTime` as `BKUnitRun` would without writing frames
+ * Sample callbacks are called as when running
+ */
+extern BKInt BKUnitSkip(BKUnit* unit, BKFUInt64 endTime);
+
+/**
+ * Check if unit would not write any frames when run
+ */
+extern BKInt BKUnitIsIdle(BKUnit const* unit);
 
 /*
  */
-extern void BKUnitEnd(BKUnit* unit, BKFUInt20 time);
+extern void BKUnitEnd(BKUnit* unit, BKFUInt64 time);
 
 /**
  * Reset unit values and buffer state
@@ -44,6 +113,21 @@ extern void BKUnitReset(BKUnit* unit);
  */
 extern void BKUnitClear(BKUnit* unit);
 
+/**
+ * Write state into `outState` if not NULL
+ * Returns the size of the state
+ */
+extern BKInt BKUnitSave(BKUnit const* unit, void* outState);
+
+/**
+ * Set state written by `BKUnitSave`
+ * Only checks if the state can be set if `check` is not 0
+ *
+ * Errors:
+ * BK_INVALID_STATE if the waveform data is not the same as when saved
+ */
+extern BKInt BKUnitRestore(BKUnit* unit, void const* inState, BKInt check);
+
 /*
  */
 extern BKInt BKUnitSampleDataStateCallback(BKEnum event, BKUnit* unit);
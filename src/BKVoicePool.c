@@ -0,0 +1,353 @@
+/*
+ * Copyright (c) 2012-2015 Simon Schoenenberger
+ * http://blipkit.audio
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "BKVoicePool.h"
+#include "BKAllocator.h"
+#include "BKTone.h"
+
+extern BKClass BKVoicePoolClass;
+
+/**
+ * Voice handles store the voice index in the lower bits and the lower note
+ * serial bits in the upper bits
+ */
+#define BK_VOICE_INDEX_BITS 16
+#define BK_VOICE_SERIAL_MASK 0x7FFF
+
+static BKInt BKVoicePoolMakeHandle(BKUInt index, BKUInt serial) {
+	return (BKInt)(((serial & BK_VOICE_SERIAL_MASK) << BK_VOICE_INDEX_BITS) | index);
+}
+
+/**
+ * Get voice index of handle or -1 if the voice was stolen
+ */
+static BKInt BKVoicePoolGetIndex(BKVoicePool const* pool, BKInt voice) {
+	BKUInt index = (BKUInt)voice & ((1 << BK_VOICE_INDEX_BITS) - 1);
+
+	if (voice < 0 || index >= pool->numVoices) {
+		return -1;
+	}
+
+	if (pool->serials[index] == 0 || BKVoicePoolMakeHandle(index, pool->serials[index]) != voice) {
+		return -1;
+	}
+
+	return index;
+}
+
+static BKInt BKVoicePoolInitGeneric(BKVoicePool* pool, BKUInt numVoices, BKEnum waveform) {
+	BKInt ret;
+
+	if (numVoices == 0 || numVoices > BK_MAX_POOL_VOICES) {
+		return BK_INVALID_VALUE;
+	}
+
+	// tracks and times first to keep alignment
+	char* block = BKMemCalloc(numVoices, sizeof(BKTrack) + sizeof(BKTime) + 2 * sizeof(BKUInt));
+
+	if (!block) {
+		return BK_ALLOCATION_ERROR;
+	}
+
+	pool->tracks = (BKTrack*)block;
+	block += numVoices * sizeof(BKTrack);
+	pool->startTimes = (BKTime*)block;
+	block += numVoices * sizeof(BKTime);
+	pool->freeVoices = (BKUInt*)block;
+	block += numVoices * sizeof(BKUInt);
+	pool->serials = (BKUInt*)block;
+
+	pool->numVoices = numVoices;
+
+	for (BKUInt i = 0; i < numVoices; i++) {
+		BKTrack* track = &pool->tracks[i];
+
+		ret = BKTrackInit(track, waveform);
+
+		if (ret < 0) {
+			return ret;
+		}
+
+		// muted tracks are idle and sleep when attached
+		BKSetAttr(track, BK_NOTE, BK_NOTE_MUTE);
+
+		// lower voices are taken first
+		pool->freeVoices[i] = numVoices - i - 1;
+	}
+
+	pool->numFreeVoices = numVoices;
+
+	return 0;
+}
+
+BKInt BKVoicePoolInit(BKVoicePool* pool, BKUInt numVoices, BKEnum waveform) {
+	BKInt ret;
+
+	if (BKObjectInit(pool, &BKVoicePoolClass, sizeof(*pool)) < 0) {
+		return -1;
+	}
+
+	ret = BKVoicePoolInitGeneric(pool, numVoices, waveform);
+
+	if (ret < 0) {
+		BKDispose(pool);
+		return ret;
+	}
+
+	return 0;
+}
+
+BKInt BKVoicePoolAlloc(BKVoicePool** outPool, BKUInt numVoices, BKEnum waveform) {
+	BKInt ret;
+
+	if (BKObjectAlloc((void**)outPool, &BKVoicePoolClass, 0) < 0) {
+		return -1;
+	}
+
+	ret = BKVoicePoolInitGeneric(*outPool, numVoices, waveform);
+
+	if (ret < 0) {
+		BKDispose(*outPool);
+		*outPool = NULL;
+		return ret;
+	}
+
+	return 0;
+}
+
+static void BKVoicePoolDisposeObject(BKVoicePool* pool) {
+	if (pool->tracks) {
+		// tracks which failed to initialize are ignored
+		for (BKUInt i = 0; i < pool->numVoices; i++) {
+			BKDispose(&pool->tracks[i]);
+		}
+	}
+
+	BKMemFree(pool->tracks);
+}
+
+BKInt BKVoicePoolAttach(BKVoicePool* pool, BKContext* ctx) {
+	BKInt ret;
+
+	if (pool->ctx) {
+		return BK_INVALID_STATE;
+	}
+
+	for (BKUInt i = 0; i < pool->numVoices; i++) {
+		ret = BKTrackAttach(&pool->tracks[i], ctx);
+
+		if (ret < 0) {
+			BKVoicePoolDetach(pool);
+			return ret;
+		}
+	}
+
+	pool->ctx = ctx;
+
+	return 0;
+}
+
+void BKVoicePoolDetach(BKVoicePool* pool) {
+	for (BKUInt i = 0; i < pool->numVoices; i++) {
+		BKTrackDetach(&pool->tracks[i]);
+	}
+
+	pool->ctx = NULL;
+}
+
+/**
+ * Return voices whose note has ended to unused voices
+ */
+static void BKVoicePoolReclaimVoices(BKVoicePool* pool) {
+	for (BKUInt i = pool->numVoices; i-- > 0;) {
+		if (pool->serials[i] && pool->tracks[i].unit.mute) {
+			pool->serials[i] = 0;
+			pool->freeVoices[pool->numFreeVoices++] = i;
+		}
+	}
+}
+
+/**
+ * Get loudest channel volume of voice including envelope
+ *
+ * The unit volume is updated when the context runs next; voices started
+ * since then are treated as loudest
+ */
+static BKInt BKVoicePoolGetVolume(BKVoicePool const* pool, BKUInt index) {
+	BKUnit const* unit = &pool->tracks[index].unit;
+	BKInt volume = 0;
+
+	if (pool->ctx && BKTimeIsEqual(pool->startTimes[index], pool->ctx->currentTime)) {
+		return BK_INT_MAX;
+	}
+
+	for (BKInt i = 0; i < BK_MAX_CHANNELS; i++) {
+		volume = BKMax(volume, unit->volume[i]);
+	}
+
+	return volume;
+}
+
+/**
+ * Find voice to steal
+ *
+ * Released notes are stolen before held notes, then quieter notes before
+ * louder notes and then older notes before newer notes
+ */
+static BKUInt BKVoicePoolFindStolenVoice(BKVoicePool const* pool) {
+	BKUInt stolen = 0;
+	BKInt stolenReleased = pool->tracks[0].curNote == -1;
+	BKInt stolenVolume = BKVoicePoolGetVolume(pool, 0);
+
+	for (BKUInt i = 1; i < pool->numVoices; i++) {
+		BKInt released = pool->tracks[i].curNote == -1;
+		BKInt volume = BKVoicePoolGetVolume(pool, i);
+
+		if (released != stolenReleased) {
+			if (!released) {
+				continue;
+			}
+		}
+		else if (volume != stolenVolume) {
+			if (volume > stolenVolume) {
+				continue;
+			}
+		}
+		else if ((BKInt)(pool->serials[i] - pool->serials[stolen]) >= 0) {
+			continue;
+		}
+
+		stolen = i;
+		stolenReleased = released;
+		stolenVolume = volume;
+	}
+
+	return stolen;
+}
+
+BKInt BKVoicePoolNoteOn(BKVoicePool* pool, BKInt note) {
+	BKInt ret;
+	BKUInt index;
+	BKTrack* track;
+
+	if (note < 0) {
+		return BK_INVALID_VALUE;
+	}
+
+	if (pool->numFreeVoices == 0) {
+		BKVoicePoolReclaimVoices(pool);
+	}
+
+	if (pool->numFreeVoices) {
+		index = pool->freeVoices[--pool->numFreeVoices];
+		track = &pool->tracks[index];
+	}
+	else {
+		index = BKVoicePoolFindStolenVoice(pool);
+		track = &pool->tracks[index];
+
+		// restart envelope
+		BKSetAttr(track, BK_NOTE, BK_NOTE_MUTE);
+	}
+
+	// 0 marks unused voices
+	if (++pool->serial == 0) {
+		pool->serial = 1;
+	}
+
+	ret = BKSetAttr(track, BK_NOTE, note);
+
+	if (ret < 0) {
+		pool->serials[index] = 0;
+		pool->freeVoices[pool->numFreeVoices++] = index;
+		return ret;
+	}
+
+	pool->serials[index] = pool->serial;
+
+	if (pool->ctx) {
+		pool->startTimes[index] = pool->ctx->currentTime;
+	}
+
+	return BKVoicePoolMakeHandle(index, pool->serial);
+}
+
+BKInt BKVoicePoolNoteOff(BKVoicePool* pool, BKInt voice) {
+	BKInt index = BKVoicePoolGetIndex(pool, voice);
+
+	if (index < 0) {
+		return BK_INVALID_STATE;
+	}
+
+	return BKSetAttr(&pool->tracks[index], BK_NOTE, BK_NOTE_RELEASE);
+}
+
+BKTrack* BKVoicePoolGetTrack(BKVoicePool* pool, BKInt voice) {
+	BKInt index = BKVoicePoolGetIndex(pool, voice);
+
+	if (index < 0) {
+		return NULL;
+	}
+
+	return &pool->tracks[index];
+}
+
+static BKInt BKVoicePoolSetAttr(BKVoicePool* pool, BKEnum attr, BKInt value) {
+	BKInt ret;
+
+	// notes are set with `BKVoicePoolNoteOn`
+	if (attr == BK_NOTE) {
+		return BK_INVALID_ATTRIBUTE;
+	}
+
+	for (BKUInt i = 0; i < pool->numVoices; i++) {
+		ret = BKSetAttr(&pool->tracks[i], attr, value);
+
+		if (ret < 0) {
+			return ret;
+		}
+	}
+
+	return 0;
+}
+
+static BKInt BKVoicePoolSetPtr(BKVoicePool* pool, BKEnum attr, void* ptr, BKSize size) {
+	BKInt ret;
+
+	for (BKUInt i = 0; i < pool->numVoices; i++) {
+		ret = BKSetPtr(&pool->tracks[i], attr, ptr, size);
+
+		if (ret < 0) {
+			return ret;
+		}
+	}
+
+	return 0;
+}
+
+BKClass BKVoicePoolClass = {
+	.instanceSize = sizeof(BKVoicePool),
+	.dispose = (BKDisposeFunc)BKVoicePoolDisposeObject,
+	.setAttr = (BKSetAttrFunc)BKVoicePoolSetAttr,
+	.setPtr = (BKSetPtrFunc)BKVoicePoolSetPtr,
+};
@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2012-2015 Simon Schoenenberger
+ * http://blipkit.audio
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef _BK_VOICE_POOL_H_
+#define _BK_VOICE_POOL_H_
+
+#include "BKTrack.h"
+
+#define BK_MAX_POOL_VOICES (1 << 16)
+
+typedef struct BKVoicePool BKVoicePool;
+
+/**
+ * A pool owns a fixed number of tracks which are handed out as voices
+ *
+ * Notes are started with `BKVoicePoolNoteOn` which returns a voice handle.
+ * When all voices are in use, the voice with the released note, the lowest
+ * volume and the oldest note in this order is stolen. Handles of stolen
+ * voices become invalid. Voices whose note has ended are muted and sleep
+ * in the context until they are used again.
+ *
+ * Attributes and pointers set on the pool are set on all tracks.
+ *
+ * All functions return 0 on success and values < 0 on error
+ */
+struct BKVoicePool {
+	BKObject object;
+	BKContext* ctx;
+	BKUInt numVoices;
+	BKUInt numFreeVoices;
+	BKUInt serial; // incremented on each note
+	BKTrack* tracks;
+	BKTime* startTimes; // context time when note was started
+	BKUInt* freeVoices; // stack of unused voices
+	BKUInt* serials;	// serial of note played by voice; 0 if unused
+};
+
+/**
+ * Initialize pool with `numVoices` tracks with `waveform`
+ *
+ * Disposing with `BKDispose` disposes all tracks
+ *
+ * Errors:
+ * BK_INVALID_VALUE if `numVoices` is not in range [1, BK_MAX_POOL_VOICES]
+ * BK_ALLOCATION_ERROR if tracks could not be allocated
+ */
+extern BKInt BKVoicePoolInit(BKVoicePool* pool, BKUInt numVoices, BKEnum waveform);
+
+/**
+ * Allocate pool
+ */
+extern BKInt BKVoicePoolAlloc(BKVoicePool** outPool, BKUInt numVoices, BKEnum waveform);
+
+/**
+ * Attach all tracks to context
+ *
+ * Errors:
+ * BK_INVALID_STATE if already attached to a context
+ */
+extern BKInt BKVoicePoolAttach(BKVoicePool* pool, BKContext* ctx);
+
+/**
+ * Detach all tracks from context
+ */
+extern void BKVoicePoolDetach(BKVoicePool* pool);
+
+/**
+ * Play `note` on an unused voice or steal a voice
+ * Does not allocate memory
+ * Unused voices are taken in constant time; voices are only searched
+ * for ended notes or for stealing when no unused voice is left
+ *
+ * Returns the voice handle
+ *
+ * Errors:
+ * BK_INVALID_VALUE if `note` is negative
+ */
+extern BKInt BKVoicePoolNoteOn(BKVoicePool* pool, BKInt note);
+
+/**
+ * Release note of voice
+ *
+ * Errors:
+ * BK_INVALID_STATE if voice was stolen
+ */
+extern BKInt BKVoicePoolNoteOff(BKVoicePool* pool, BKInt voice);
+
+/**
+ * Get track of voice or NULL if voice was stolen
+ */
+extern BKTrack* BKVoicePoolGetTrack(BKVoicePool* pool, BKInt voice);
+
+#endif /* ! _BK_VOICE_POOL_H_ */
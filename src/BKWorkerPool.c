@@ -0,0 +1,193 @@
+/*
+ * Copyright (c) 2012-2015 Simon Schoenenberger
+ * http://blipkit.audio
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "BKWorkerPool.h"
+#include "BKAllocator.h"
+
+#if BK_USE_THREADS
+
+#include <pthread.h>
+
+typedef struct BKWorker BKWorker;
+
+struct BKWorker {
+	BKWorkerPool* pool;
+	BKUInt index;
+	pthread_t thread;
+};
+
+struct BKWorkerPool {
+	BKUInt numWorkers;
+	BKUInt numThreads; // number of started threads
+	BKWorkerFunc func;
+	void* info;
+	pthread_mutex_t mutex;
+	pthread_cond_t startCond;
+	pthread_cond_t doneCond;
+	BKUInt generation; // incremented on each run
+	BKUInt numPending; // number of threads still running
+	BKInt quit;
+	BKWorker workers[];
+};
+
+static void* BKWorkerMain(BKWorker* worker) {
+	BKWorkerPool* pool = worker->pool;
+	BKUInt generation = 0;
+
+	pthread_mutex_lock(&pool->mutex);
+
+	for (;;) {
+		while (pool->generation == generation && !pool->quit) {
+			pthread_cond_wait(&pool->startCond, &pool->mutex);
+		}
+
+		if (pool->quit) {
+			break;
+		}
+
+		generation = pool->generation;
+		pthread_mutex_unlock(&pool->mutex);
+
+		pool->func(pool->info, worker->index);
+
+		pthread_mutex_lock(&pool->mutex);
+
+		if (--pool->numPending == 0) {
+			pthread_cond_signal(&pool->doneCond);
+		}
+	}
+
+	pthread_mutex_unlock(&pool->mutex);
+
+	return NULL;
+}
+
+BKInt BKWorkerPoolAlloc(BKWorkerPool** outPool, BKUInt numWorkers, BKWorkerFunc func, void* info) {
+	BKWorkerPool* pool;
+
+	*outPool = NULL;
+
+	if (numWorkers < 1 || numWorkers > BK_MAX_WORKERS) {
+		return BK_INVALID_VALUE;
+	}
+
+	pool = BKMemCalloc(1, sizeof(*pool) + numWorkers * sizeof(BKWorker));
+
+	if (pool == NULL) {
+		return BK_ALLOCATION_ERROR;
+	}
+
+	pool->numWorkers = numWorkers;
+	pool->func = func;
+	pool->info = info;
+
+	pthread_mutex_init(&pool->mutex, NULL);
+	pthread_cond_init(&pool->startCond, NULL);
+	pthread_cond_init(&pool->doneCond, NULL);
+
+	// worker 0 is the calling thread
+	for (BKUInt i = 1; i < numWorkers; i++) {
+		BKWorker* worker = &pool->workers[i];
+
+		worker->pool = pool;
+		worker->index = i;
+
+		if (pthread_create(&worker->thread, NULL, (void* (*)(void*))BKWorkerMain, worker) != 0) {
+			BKWorkerPoolFree(pool);
+			return BK_ALLOCATION_ERROR;
+		}
+
+		pool->numThreads++;
+	}
+
+	*outPool = pool;
+
+	return 0;
+}
+
+void BKWorkerPoolFree(BKWorkerPool* pool) {
+	if (pool == NULL) {
+		return;
+	}
+
+	pthread_mutex_lock(&pool->mutex);
+	pool->quit = 1;
+	pthread_cond_broadcast(&pool->startCond);
+	pthread_mutex_unlock(&pool->mutex);
+
+	for (BKUInt i = 1; i <= pool->numThreads; i++) {
+		pthread_join(pool->workers[i].thread, NULL);
+	}
+
+	pthread_cond_destroy(&pool->doneCond);
+	pthread_cond_destroy(&pool->startCond);
+	pthread_mutex_destroy(&pool->mutex);
+
+	BKMemFree(pool);
+}
+
+void BKWorkerPoolRun(BKWorkerPool* pool) {
+	pthread_mutex_lock(&pool->mutex);
+	pool->numPending = pool->numThreads;
+	pool->generation++;
+	pthread_cond_broadcast(&pool->startCond);
+	pthread_mutex_unlock(&pool->mutex);
+
+	pool->func(pool->info, 0);
+
+	pthread_mutex_lock(&pool->mutex);
+
+	while (pool->numPending) {
+		pthread_cond_wait(&pool->doneCond, &pool->mutex);
+	}
+
+	pthread_mutex_unlock(&pool->mutex);
+}
+
+BKUInt BKWorkerPoolSize(BKWorkerPool const* pool) {
+	return pool->numWorkers;
+}
+
+#else /* ! BK_USE_THREADS */
+
+BKInt BKWorkerPoolAlloc(BKWorkerPool** outPool, BKUInt numWorkers, BKWorkerFunc func, void* info) {
+	*outPool = NULL;
+
+	if (numWorkers < 1 || numWorkers > BK_MAX_WORKERS) {
+		return BK_INVALID_VALUE;
+	}
+
+	return BK_INVALID_STATE;
+}
+
+void BKWorkerPoolFree(BKWorkerPool* pool) {
+}
+
+void BKWorkerPoolRun(BKWorkerPool* pool) {
+}
+
+BKUInt BKWorkerPoolSize(BKWorkerPool const* pool) {
+	return 1;
+}
+
+#endif /* BK_USE_THREADS */
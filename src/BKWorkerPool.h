@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2012-2015 Simon Schoenenberger
+ * http://blipkit.audio
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef _BK_WORKER_POOL_H_
+#define _BK_WORKER_POOL_H_
+
+#include "BKBase.h"
+
+#define BK_MAX_WORKERS 16
+
+typedef struct BKWorkerPool BKWorkerPool;
+
+/**
+ * Worker function
+ * `index` is the worker index in range [0, number of workers)
+ */
+typedef void (*BKWorkerFunc)(void* info, BKUInt index);
+
+/**
+ * Allocate pool with `numWorkers` workers
+ * Worker 0 is the calling thread, the other workers run on their own thread
+ *
+ * Errors:
+ * BK_INVALID_VALUE if `numWorkers` is not in range [1, BK_MAX_WORKERS]
+ * BK_INVALID_STATE if threads are not supported
+ * BK_ALLOCATION_ERROR if pool or threads could not be created
+ */
+extern BKInt BKWorkerPoolAlloc(BKWorkerPool** outPool, BKUInt numWorkers, BKWorkerFunc func, void* info);
+
+/**
+ * Stop threads and free pool
+ */
+extern void BKWorkerPoolFree(BKWorkerPool* pool);
+
+/**
+ * Call worker function on all workers and wait until all have returned
+ */
+extern void BKWorkerPoolRun(BKWorkerPool* pool);
+
+/**
+ * Get number of workers
+ */
+extern BKUInt BKWorkerPoolSize(BKWorkerPool const* pool);
+
+#endif /* ! _BK_WORKER_POOL_H_ */
@@ -28,9 +28,11 @@
 extern "C" {
 #endif
 
+#include "BKAllocator.h"
 #include "BKBase.h"
 #include "BKBuffer.h"
 #include "BKClock.h"
+#include "BKCommandQueue.h"
 #include "BKContext.h"
 #include "BKData.h"
 #include "BKInstrument.h"
@@ -41,8 +43,11 @@ extern "C" {
 #include "BKTone.h"
 #include "BKTrack.h"
 #include "BKUnit.h"
+#include "BKUnitBank.h"
+#include "BKVoicePool.h"
 #include "BKWaveFileReader.h"
 #include "BKWaveFileWriter.h"
+#include "BKWorkerPool.h"
 
 #ifdef __cplusplus
 }
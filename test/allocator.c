@@ -0,0 +1,67 @@
+#include "test.h"
+
+int main(int argc, char const* argv[]) {
+	// check arena allocator
+
+	BKArena arena;
+	BKAllocator allocator;
+	BKContext* ctx;
+	BKTrack* track;
+	BKData* data;
+	BKFrame dataFrames[16];
+	BKFrame frames[2 * 300];
+	BKInt nonzero = 0;
+
+	for (BKInt i = 0; i < 16; i++) {
+		dataFrames[i] = i * 4000 - 32000;
+	}
+
+	assert(BKArenaInit(&arena, NULL, 1 << 20) == 0);
+	BKArenaGetAllocator(&arena, &allocator);
+	allocator.free = NULL;
+	assert(BKSetAllocator(&allocator) == BK_INVALID_VALUE);
+	BKArenaGetAllocator(&arena, &allocator);
+	assert(BKSetAllocator(&allocator) == 0);
+
+	// last allocation is resized in place and released
+	char* block = BKMemAlloc(100);
+	assert(block >= arena.data && block < arena.data + arena.size);
+	assert(((BKUSize)block & (BK_ARENA_ALIGN - 1)) == 0);
+	assert(BKMemRealloc(block, 1000) == block);
+	BKMemFree(block);
+	assert(arena.offset == 0);
+	assert(BKMemAlloc(1 << 20) == NULL);
+
+	// objects are allocated from arena
+	assert(BKContextAlloc(&ctx, 2, 44100) == 0);
+	assert(BKTrackAlloc(&track, BK_SQUARE) == 0);
+	assert(BKDataAlloc(&data) == 0);
+	assert((char*)ctx >= arena.data && (char*)ctx < arena.data + arena.size);
+
+	assert(BKDataSetFrames(data, dataFrames, 16, 1, 1) == 0);
+	BKTrackAttach(track, ctx);
+	assert(BKSetPtr(track, BK_WAVEFORM, data, 0) == 0);
+	BKSetAttr(track, BK_MASTER_VOLUME, BK_MAX_VOLUME / 4);
+	BKSetAttr(track, BK_VOLUME, BK_MAX_VOLUME);
+	BKSetAttr(track, BK_NOTE, BK_A_4 * BK_FINT20_UNIT);
+	assert(BKContextGenerate(ctx, frames, 300) == 300);
+
+	for (BKInt i = 0; i < 2 * 300; i++) {
+		nonzero |= frames[i];
+	}
+
+	assert(nonzero != 0);
+
+	BKDispose(track);
+	BKDispose(data);
+	BKDispose(ctx);
+	BKSetAllocator(NULL);
+
+	// objects are released at once
+	assert(arena.offset > 0);
+	BKArenaReset(&arena);
+	assert(arena.offset == 0);
+	BKArenaDispose(&arena);
+
+	return 0;
+}
@@ -0,0 +1,122 @@
+#include "test.h"
+
+int main(int argc, char const* argv[]) {
+	// check pulse functions
+
+	BKBufferAddPulseFunc funcs[8];
+	BKInt numFuncs = BKBufferGetAddPulseFuncs(funcs, 8);
+	BKFrame phase[BK_STEP_WIDTH];
+	BKInt frames[BK_STEP_WIDTH];
+	BKInt expectedFrames[BK_STEP_WIDTH];
+	BKFrame pulses[4] = {1, -1, 32767, -32768};
+	BKUInt seed = 1;
+
+	assert(numFuncs >= 1);
+	assert(BKBufferGetAddPulseFuncs(funcs, 1) == 1);
+	assert(BKBufferGetAddPulseFuncs(funcs, 8) == numFuncs);
+	assert(BKBufferGetAddPulseFunc() == funcs[numFuncs - 1]);
+
+	for (BKInt i = 0; i < BK_STEP_WIDTH; i++) {
+		seed = seed * 1103515245 + 12345;
+		phase[i] = (BKFrame)(seed >> 16);
+	}
+
+	phase[0] = -32768;
+	phase[1] = 32767;
+
+	// every function gives the same result as the scalar function
+	for (BKInt f = 1; f < numFuncs; f++) {
+		for (BKUInt width = 8; width <= BK_STEP_WIDTH; width += 8) {
+			for (BKInt p = 0; p < 4; p++) {
+				for (BKInt i = 0; i < BK_STEP_WIDTH; i++) {
+					frames[i] = expectedFrames[i] = i * 1000 - 16000;
+				}
+
+				funcs[0](expectedFrames, phase, pulses[p], width);
+				funcs[f](frames, phase, pulses[p], width);
+
+				assert(memcmp(frames, expectedFrames, sizeof(frames)) == 0);
+			}
+		}
+	}
+
+	// check pulse kernels
+
+	BKBufferPulse pulse;
+
+	assert(BKBufferPulseInit(&pulse, BK_PULSE_KERNEL_SINC, 12, 1.0) == BK_INVALID_VALUE);
+	assert(BKBufferPulseInit(&pulse, BK_PULSE_KERNEL_SINC, 8, 0.0) == BK_INVALID_VALUE);
+	assert(BKBufferPulseInit(&pulse, BK_PULSE_KERNEL_SINC, BK_STEP_WIDTH, 1.0) == 0);
+	assert(BKBufferPulseInit(&pulse, BK_PULSE_KERNEL_HARM, 8, 1.0) == 0);
+	assert(pulse.width == 8);
+
+	// steps have the same delay as pulses
+
+	BKBufferPulse const* kernels[3] = {BKBufferPulseKernels[BK_PULSE_KERNEL_SINC], BKBufferPulseKernels[BK_PULSE_KERNEL_HARM], &pulse};
+	BKBuffer bufs[2];
+
+	for (BKInt k = 0; k < 3; k++) {
+		double centers[2];
+
+		for (BKInt b = 0; b < 2; b++) {
+			double sum = 0.0, moment = 0.0;
+
+			BKBufferInit(&bufs[b]);
+			bufs[b].pulse = kernels[k];
+
+			if (b == 0) {
+				BKBufferAddPulse(&bufs[b], 3 * BK_FINT20_UNIT + BK_FINT20_UNIT / 4, 1000);
+			}
+			else {
+				BKBufferAddStep(&bufs[b], 3 * BK_FINT20_UNIT + BK_FINT20_UNIT / 4, 1000);
+			}
+
+			for (BKInt i = 0; i < BK_STEP_WIDTH + 8; i++) {
+				sum += bufs[b].frames[i];
+				moment += (double)i * bufs[b].frames[i];
+			}
+
+			centers[b] = moment / sum;
+			BKBufferDispose(&bufs[b]);
+		}
+
+		assert(centers[1] - centers[0] < 0.05 && centers[0] - centers[1] < 0.05);
+	}
+
+	// adding steps at once is the same as adding single steps across ring end
+
+	BKFrame levels[2 * 200];
+	BKFrame readFrames[4000];
+	BKInt lastLevels[2] = {0, 0};
+
+	for (BKInt i = 0; i < 2 * 200; i++) {
+		seed = seed * 1103515245 + 12345;
+		levels[i] = (BKFrame)(seed >> 16);
+	}
+
+	for (BKInt b = 0; b < 2; b++) {
+		BKBufferInit(&bufs[b]);
+		BKBufferEnd(&bufs[b], (BKFUInt64)4000 << BK_FINT20_SHIFT);
+		assert(BKBufferRead(&bufs[b], readFrames, 4000, 1) == 4000);
+	}
+
+	assert(bufs[0].head + 200 > bufs[0].mask + 1);
+
+	BKBufferAddSteps(&bufs[0], BK_FINT20_UNIT / 3, levels, 2, 200, BK_MAX_VOLUME / 2, &lastLevels[0]);
+
+	for (BKInt i = 0; i < 200; i++) {
+		BKInt level = (levels[i * 2] * (BK_MAX_VOLUME / 2)) >> BK_VOLUME_SHIFT;
+
+		BKBufferAddStep(&bufs[1], (BKFUInt64)i * BK_FINT20_UNIT + BK_FINT20_UNIT / 3, level - lastLevels[1]);
+		lastLevels[1] = level;
+	}
+
+	assert(lastLevels[0] == lastLevels[1]);
+	assert(memcmp(bufs[0].frames, bufs[1].frames, (bufs[0].mask + 1) * sizeof(BKInt)) == 0);
+
+	for (BKInt b = 0; b < 2; b++) {
+		BKBufferDispose(&bufs[b]);
+	}
+
+	return 0;
+}
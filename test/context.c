@@ -1,4 +1,92 @@
 #include "test.h"
+#include <math.h>
+
+static BKFrame largeBuffer[2 * 30000];
+
+static BKInt clockTicks[8];
+static BKInt numClockTicks;
+
+static BKEnum clockTick(BKCallbackInfo* info, void* userInfo) {
+	if (numClockTicks < 8) {
+		clockTicks[numClockTicks++] = (BKInt)(BKSize)userInfo;
+	}
+
+	return 0;
+}
+
+static BKInt eventTimes[8];
+static BKInt numEvents;
+
+static BKEnum eventCallback(BKCallbackInfo* info, void* userInfo) {
+	BKInt time = BKTimeGetTime(info->nextTime);
+
+	if (numEvents < 8) {
+		eventTimes[numEvents++] = time + (BKInt)(BKSize)userInfo;
+	}
+
+	// repeat every 100 frames
+	if (userInfo) {
+		info->nextTime = BKTimeAdd(info->nextTime, BKTimeMake(100, 0));
+	}
+
+	return 0;
+}
+
+static BKInt numFillEvents;
+
+static BKEnum fillEvents(BKCallbackInfo* info, void* userInfo) {
+	BKCallback callback = {0};
+
+	numFillEvents++;
+
+	// schedule events until allocation fails
+	while (BKContextScheduleEvent(info->object, BK_TIME_MAX, &callback) == 0);
+
+	info->nextTime = BKTimeAdd(info->nextTime, BKTimeMake(100, 0));
+
+	return 0;
+}
+
+static BKInt numAllocs;
+
+static void* limitedAlloc(BKUSize size, void* info) {
+	return numAllocs-- > 0 ? malloc(size) : NULL;
+}
+
+static void* limitedRealloc(void* ptr, BKUSize size, void* info) {
+	return numAllocs-- > 0 ? realloc(ptr, size) : NULL;
+}
+
+static void limitedFree(void* ptr, void* info) {
+	free(ptr);
+}
+
+static BKEnum unmuteTrack(BKCallbackInfo* info, void* userInfo) {
+	if (info->event == BK_EVENT_SAMPLE_RESET) {
+		BKSetAttr(userInfo, BK_MUTE, 0);
+	}
+
+	return 0;
+}
+
+static BKInt numWrites;
+static BKUInt maxWriteSize;
+
+static BKInt writeFrames(BKFrame inFrames[], BKUInt size, void* info) {
+	numWrites++;
+	maxWriteSize = BKMax(maxWriteSize, size);
+
+	return 0;
+}
+
+static void renderSquare(BKContext* ctx, BKTrack* track) {
+	BKContextInit(ctx, 2, 44100);
+	BKTrackInit(track, BK_SQUARE);
+	BKTrackAttach(track, ctx);
+	BKSetAttr(track, BK_MASTER_VOLUME, BK_MAX_VOLUME / 4);
+	BKSetAttr(track, BK_VOLUME, BK_MAX_VOLUME);
+	BKSetAttr(track, BK_NOTE, BK_A_4 * BK_FINT20_UNIT);
+}
 
 int main(int argc, char const* argv[]) {
 	BKInt res;
@@ -22,5 +110,585 @@ int main(int argc, char const* argv[]) {
 
 	BKDispose(ctx);
 
+	// check output formats
+
+	BKContext ctxs[3];
+	BKTrack tracks[3];
+	BKFrame frames[2 * 300];
+	BKFrame left[300], right[300];
+	float floatFrames[2 * 300];
+	BKFrame* planar[2] = {left, right};
+
+	for (BKInt i = 0; i < 3; i++) {
+		renderSquare(&ctxs[i], &tracks[i]);
+	}
+
+	assert(BKContextGenerate(&ctxs[0], frames, 300) == 300);
+	assert(BKContextGeneratePlanar(&ctxs[1], planar, 300) == 300);
+	assert(BKContextGenerateFloat(&ctxs[2], floatFrames, 300) == 300);
+
+	for (BKInt i = 0; i < 300; i++) {
+		assert(frames[i * 2 + 0] == left[i]);
+		assert(frames[i * 2 + 1] == right[i]);
+		assert(fabsf(floatFrames[i * 2] * 32768.0f - frames[i * 2]) < 1.0f);
+	}
+
+	// check buffer capacity
+
+	BKInt capacity = 0;
+	BKFrame largeFrames[2 * 300];
+
+	assert(BKSetAttr(&ctxs[1], BK_CONTEXT_BUFFER_CAPACITY, 100) == BK_INVALID_VALUE);
+	assert(BKSetAttr(&ctxs[1], BK_CONTEXT_BUFFER_CAPACITY, BK_MAX_BUFFER_CAPACITY) == 0);
+	assert(BKGetAttr(&ctxs[1], BK_CONTEXT_BUFFER_CAPACITY, &capacity) == 0);
+	assert(capacity == BK_MAX_BUFFER_CAPACITY);
+
+	for (BKInt i = 0; i < 101; i++) {
+		BKContextGenerate(&ctxs[0], frames, 300);
+	}
+
+	assert(BKContextGenerate(&ctxs[1], largeBuffer, 30000) == 30000);
+	assert(BKContextGenerate(&ctxs[1], largeFrames, 300) == 300);
+	assert(memcmp(frames, largeFrames, sizeof(frames)) == 0);
+
+	// capacity is unchanged if not all channels could be allocated
+	BKContext capacityCtx;
+	BKAllocator limitedAllocator = {limitedAlloc, limitedRealloc, limitedFree, NULL};
+
+	BKContextInit(&capacityCtx, 2, 44100);
+	numAllocs = 1;
+	assert(BKSetAllocator(&limitedAllocator) == 0);
+	assert(BKSetAttr(&capacityCtx, BK_CONTEXT_BUFFER_CAPACITY, BK_MAX_BUFFER_CAPACITY) == BK_ALLOCATION_ERROR);
+	assert(BKSetAllocator(NULL) == 0);
+	assert(BKGetAttr(&capacityCtx, BK_CONTEXT_BUFFER_CAPACITY, &capacity) == 0);
+	assert(capacity == BK_DEFAULT_BUFFER_CAPACITY);
+	assert(capacityCtx.channels[1].maxCapacity == BK_DEFAULT_BUFFER_CAPACITY);
+	assert(capacityCtx.channels[1].mask + 1 == 4096);
+	assert(BKSetAttr(&capacityCtx, BK_CONTEXT_BUFFER_CAPACITY, BK_MAX_BUFFER_CAPACITY) == 0);
+	BKDispose(&capacityCtx);
+
+	// frames are generated to time in blocks of buffer capacity
+	BKContext timeCtx;
+	BKTrack timeTrack;
+
+	renderSquare(&timeCtx, &timeTrack);
+	assert(BKSetAttr(&timeCtx, BK_CONTEXT_BUFFER_CAPACITY, BK_MAX_BUFFER_CAPACITY) == 0);
+	assert(BKContextGenerateToTime(&timeCtx, BKTimeMake(30000, 0), writeFrames, NULL) >= 30000);
+	assert(maxWriteSize > BK_DEFAULT_BUFFER_CAPACITY && maxWriteSize <= BK_MAX_BUFFER_CAPACITY);
+	assert(numWrites == 1);
+	BKDispose(&timeTrack);
+	BKDispose(&timeCtx);
+
+	// run and end return end time
+
+	BKContext runCtx;
+	BKTrack runTrack;
+
+	renderSquare(&runCtx, &runTrack);
+	assert(BKContextRun(&runCtx, 100 << BK_FINT20_SHIFT) == 100 << BK_FINT20_SHIFT);
+	assert(BKContextEnd(&runCtx, 200 << BK_FINT20_SHIFT) == 200 << BK_FINT20_SHIFT);
+	assert(BKContextSize(&runCtx) == 200);
+	assert(BKSetAttr(&runCtx, BK_CONTEXT_BUFFER_CAPACITY, BK_MAX_BUFFER_CAPACITY) == 0);
+	assert(BKContextEnd(&runCtx, (BKFUInt64)4096 << BK_FINT20_SHIFT) == BK_INT_MAX);
+	BKDispose(&runTrack);
+	BKDispose(&runCtx);
+
+	// check threads
+
+	BKContext threadCtxs[2];
+	BKTrack threadTracks[2][5];
+	BKInt numThreads = 0;
+
+	for (BKInt i = 0; i < 2; i++) {
+		BKContextInit(&threadCtxs[i], 2, 44100);
+
+		for (BKInt j = 0; j < 5; j++) {
+			BKTrack* track = &threadTracks[i][j];
+
+			BKTrackInit(track, j % 2 ? BK_TRIANGLE : BK_SQUARE);
+			BKTrackAttach(track, &threadCtxs[i]);
+			BKSetAttr(track, BK_MASTER_VOLUME, BK_MAX_VOLUME / 8);
+			BKSetAttr(track, BK_VOLUME, BK_MAX_VOLUME);
+			BKSetAttr(track, BK_NOTE, (BK_A_3 + j * 5) * BK_FINT20_UNIT);
+		}
+	}
+
+	assert(BKSetAttr(&threadCtxs[1], BK_NUM_THREADS, 0) == BK_INVALID_VALUE);
+	res = BKSetAttr(&threadCtxs[1], BK_NUM_THREADS, 3);
+	assert(res == 0 || res == BK_INVALID_STATE);
+	assert(BKGetAttr(&threadCtxs[1], BK_NUM_THREADS, &numThreads) == 0);
+	assert(numThreads == (res == 0 ? 3 : 1));
+
+	for (BKInt i = 0; i < 10; i++) {
+		assert(BKContextGenerate(&threadCtxs[0], frames, 300) == 300);
+		assert(BKContextGenerate(&threadCtxs[1], largeFrames, 300) == 300);
+		assert(memcmp(frames, largeFrames, sizeof(frames)) == 0);
+	}
+
+	// sample callbacks on workers wake units after all workers have finished
+	BKUnit threadUnits[2];
+	BKData threadSample;
+	BKFrame threadSampleFrames[500];
+
+	for (BKInt i = 0; i < 500; i++) {
+		threadSampleFrames[i] = (i * 131) % 20000 - 10000;
+	}
+
+	BKDataInit(&threadSample);
+	BKDataSetFrames(&threadSample, threadSampleFrames, 500, 1, 1);
+
+	for (BKInt i = 0; i < 2; i++) {
+		BKCallback callback = {.func = unmuteTrack, .userInfo = &threadTracks[i][4]};
+
+		BKSetAttr(&threadTracks[i][4], BK_MUTE, 1);
+		BKUnitInit(&threadUnits[i], BK_SQUARE);
+		BKUnitAttach(&threadUnits[i], &threadCtxs[i]);
+		BKSetPtr(&threadUnits[i], BK_SAMPLE, &threadSample, 0);
+		BKSetPtr(&threadUnits[i], BK_SAMPLE_CALLBACK, &callback, sizeof(callback));
+		BKSetAttr(&threadUnits[i], BK_PERIOD, BK_FINT20_UNIT);
+		BKSetAttr(&threadUnits[i], BK_VOLUME, BK_MAX_VOLUME / 4);
+	}
+
+	for (BKInt i = 0; i < 10; i++) {
+		assert(BKContextGenerate(&threadCtxs[0], frames, 300) == 300);
+		assert(BKContextGenerate(&threadCtxs[1], largeFrames, 300) == 300);
+		assert(memcmp(frames, largeFrames, sizeof(frames)) == 0);
+	}
+
+	assert(threadTracks[1][4].unit.object.flags & BKUnitFlagActive);
+
+	for (BKInt i = 0; i < 2; i++) {
+		BKDispose(&threadUnits[i]);
+
+		for (BKInt j = 0; j < 5; j++) {
+			BKDispose(&threadTracks[i][j]);
+		}
+
+		BKDispose(&threadCtxs[i]);
+	}
+
+	BKDispose(&threadSample);
+
+	// check clock order
+
+	BKClock clocks[3];
+	BKCallback clockCallback = {.func = clockTick};
+
+	for (BKInt i = 0; i < 3; i++) {
+		clockCallback.userInfo = (void*)(BKSize)i;
+		BKClockInit(&clocks[i], BKTimeMake(100 * (i + 1), 0), &clockCallback);
+	}
+
+	BKClockAttach(&clocks[2], &ctxs[0], NULL);
+	BKClockAttach(&clocks[0], &ctxs[0], BK_FIRST_ELEMENT_PTR);
+	BKClockAttach(&clocks[1], &ctxs[0], &clocks[2]);
+	assert(BKContextGenerate(&ctxs[0], frames, 300) == 300);
+	assert(BKContextGenerate(&ctxs[0], frames, 100) == 100);
+
+	// all tick at 0, then at 100, 200 and 300 frames
+	// the context runs less than 100 frames ahead of the generated frames
+	BKInt expectedTicks[8] = {0, 1, 2, 0, 0, 1, 0, 2};
+
+	assert(numClockTicks == 8);
+	assert(memcmp(clockTicks, expectedTicks, sizeof(expectedTicks)) == 0);
+
+	// clocks keep list order when gap before clock is used up
+	BKClock moreClocks[16];
+
+	for (BKInt i = 0; i < 16; i++) {
+		BKClockInit(&moreClocks[i], BKTimeMake(100, 0), NULL);
+		assert(BKClockAttach(&moreClocks[i], &ctxs[0], &clocks[1]) == 0);
+	}
+
+	for (BKClock* clock = ctxs[0].firstClock; clock->nextClock; clock = clock->nextClock) {
+		assert(clock->order < clock->nextClock->order);
+	}
+
+	for (BKInt i = 0; i < 16; i++) {
+		BKDispose(&moreClocks[i]);
+	}
+
+	for (BKInt i = 0; i < 3; i++) {
+		BKDispose(&clocks[i]);
+	}
+
+	// check queued commands
+
+	BKContext cmdCtxs[2];
+	BKTrack cmdTracks[2];
+	BKFrame cmdFrames[2][2 * 300];
+
+	for (BKInt i = 0; i < 2; i++) {
+		renderSquare(&cmdCtxs[i], &cmdTracks[i]);
+	}
+
+	assert(BKContextQueueAttr(&cmdCtxs[1], BKTimeMake(100, 0), &cmdTracks[1], BK_VOLUME, 0) == 0);
+
+	for (BKInt i = 0; i < 2; i++) {
+		assert(BKContextGenerate(&cmdCtxs[i], cmdFrames[i], 300) == 300);
+	}
+
+	// frames do not change before command time
+	assert(memcmp(cmdFrames[0], cmdFrames[1], sizeof(BKFrame) * 2 * 100) == 0);
+	assert(memcmp(cmdFrames[0], cmdFrames[1], sizeof(cmdFrames[0])) != 0);
+
+	// check scheduled events
+
+	BKCallback eventCallbacks[2] = {
+		{.func = eventCallback, .userInfo = (void*)0},
+		{.func = eventCallback, .userInfo = (void*)1},
+	};
+	BKTime eventStart;
+
+	BKGetPtr(&cmdCtxs[0], BK_TIME, &eventStart, sizeof(eventStart));
+	BKContextScheduleEvent(&cmdCtxs[0], BKTimeAdd(eventStart, BKTimeMake(50, 0)), &eventCallbacks[0]);
+	BKContextScheduleEvent(&cmdCtxs[0], BKTimeAdd(eventStart, BKTimeMake(10, 0)), &eventCallbacks[1]);
+	BKContextScheduleEvent(&cmdCtxs[0], BKTimeAdd(eventStart, BKTimeMake(50, 0)), &eventCallbacks[0]);
+	assert(BKContextGenerate(&cmdCtxs[0], cmdFrames[0], 300) == 300);
+
+	BKInt start = BKTimeGetTime(eventStart);
+	BKInt expectedEvents[5] = {start + 11, start + 50, start + 50, start + 111, start + 211};
+
+	assert(numEvents >= 5);
+	assert(memcmp(eventTimes, expectedEvents, sizeof(expectedEvents)) == 0);
+
+	for (res = 0; res == 0;) {
+		res = BKContextQueueAttr(&cmdCtxs[0], BK_TIME_MAX, &cmdTracks[0], BK_VOLUME, 0);
+	}
+
+	assert(res == BK_INVALID_STATE);
+
+	// repeating event is rescheduled if no more events can be allocated
+	BKCallback fillCallback = {.func = fillEvents};
+
+	BKContextScheduleEvent(&cmdCtxs[1], BK_TIME_ZERO, &fillCallback);
+	numAllocs = 0;
+	assert(BKSetAllocator(&limitedAllocator) == 0);
+	assert(BKContextGenerate(&cmdCtxs[1], cmdFrames[1], 300) == 300);
+	assert(BKSetAllocator(NULL) == 0);
+	assert(numFillEvents >= 3);
+
+	for (BKInt i = 0; i < 2; i++) {
+		BKDispose(&cmdTracks[i]);
+		BKDispose(&cmdCtxs[i]);
+	}
+
+	// check sleeping units
+
+	BKContext sleepCtx;
+	BKTrack sleepTrack;
+
+	renderSquare(&sleepCtx, &sleepTrack);
+	assert(BKContextGenerate(&sleepCtx, frames, 300) == 300);
+	assert(sleepCtx.firstActiveUnit == &sleepTrack.unit);
+
+	BKUInt sleepPhase = sleepTrack.unit.phase.phase;
+
+	BKSetAttr(&sleepTrack, BK_MUTE, 1);
+	assert(BKContextGenerate(&sleepCtx, frames, 300) == 300);
+	assert(sleepCtx.firstActiveUnit == NULL);
+	assert(sleepTrack.unit.phase.phase == sleepPhase);
+
+	BKSetAttr(&sleepTrack, BK_MUTE, 0);
+	assert(sleepCtx.firstActiveUnit == &sleepTrack.unit);
+	assert(BKContextGenerate(&sleepCtx, frames, 300) == 300);
+
+	// units woken by sample callbacks run in the same pass
+	BKUnit wakeUnit;
+	BKData wakeSample;
+	BKFrame wakeFrames[200] = {0, 16000, -16000, 0};
+	BKCallback wakeCallback = {.func = unmuteTrack, .userInfo = &sleepTrack};
+
+	BKSetAttr(&sleepTrack, BK_MUTE, 1);
+	assert(BKContextGenerate(&sleepCtx, frames, 300) == 300);
+	assert(sleepCtx.firstActiveUnit == NULL);
+
+	BKDataInit(&wakeSample);
+	BKDataSetFrames(&wakeSample, wakeFrames, 200, 1, 1);
+	BKUnitInit(&wakeUnit, BK_SQUARE);
+	BKUnitAttach(&wakeUnit, &sleepCtx);
+	BKSetPtr(&wakeUnit, BK_SAMPLE, &wakeSample, 0);
+	BKSetPtr(&wakeUnit, BK_SAMPLE_CALLBACK, &wakeCallback, sizeof(wakeCallback));
+	BKSetAttr(&wakeUnit, BK_PERIOD, BK_FINT20_UNIT);
+	BKSetAttr(&wakeUnit, BK_VOLUME, BK_MAX_VOLUME / 4);
+	assert(BKContextGenerate(&sleepCtx, frames, 300) == 300);
+	assert(sleepTrack.unit.object.flags & BKUnitFlagActive);
+	assert(sleepTrack.unit.time <= BK_MAX_RUN_PERIOD);
+
+	BKDispose(&wakeUnit);
+	BKDispose(&wakeSample);
+	BKDispose(&sleepTrack);
+	BKDispose(&sleepCtx);
+
+	// check unit bank
+
+	BKContext bankCtxs[2];
+	BKUnit bankUnits[8];
+	BKUnitBank bank;
+	BKEnum bankWaveforms[8] = {BK_SQUARE, BK_SQUARE, BK_TRIANGLE, BK_TRIANGLE, BK_NOISE, BK_NOISE, BK_SAWTOOTH, BK_SINE};
+
+	for (BKInt i = 0; i < 2; i++) {
+		BKContextInit(&bankCtxs[i], 2, 44100);
+	}
+
+	assert(BKUnitBankInit(&bank, 0) == BK_INVALID_VALUE);
+	assert(BKUnitBankInit(&bank, 16) == 0);
+	assert(BKUnitBankSetVoiceAttr(&bank, 16, BK_VOLUME, BK_MAX_VOLUME) == BK_INVALID_VALUE);
+	assert(BKUnitBankSetVoiceAttr(&bank, 0, BK_WAVEFORM, BK_SAMPLE) == BK_INVALID_VALUE);
+	BKUnitBankAttach(&bank, &bankCtxs[1]);
+
+	// voice pairs with the same waveform share the period
+	for (BKInt i = 0; i < 8; i++) {
+		BKInt period = (BKInt)(100.5 * BK_FINT20_UNIT) + (i / 2) * 7;
+		BKInt volume = BK_MAX_VOLUME / 8 + i * 100;
+
+		BKUnitInit(&bankUnits[i], bankWaveforms[i]);
+		BKUnitAttach(&bankUnits[i], &bankCtxs[0]);
+		BKSetAttr(&bankUnits[i], BK_PERIOD, period);
+		BKSetAttr(&bankUnits[i], BK_VOLUME, volume);
+
+		BKUnitBankSetVoiceAttr(&bank, i * 2, BK_WAVEFORM, bankWaveforms[i]);
+		BKUnitBankSetVoiceAttr(&bank, i * 2, BK_PERIOD, period);
+		BKUnitBankSetVoiceAttr(&bank, i * 2, BK_VOLUME, volume);
+
+		if (i == 1) {
+			BKSetAttr(&bankUnits[i], BK_DUTY_CYCLE, 8);
+			BKUnitBankSetVoiceAttr(&bank, i * 2, BK_DUTY_CYCLE, 8);
+		}
+
+		if (i == 3) {
+			BKSetAttr(&bankUnits[i], BK_PHASE, 5);
+			BKUnitBankSetVoiceAttr(&bank, i * 2, BK_PHASE, 5);
+		}
+	}
+
+	// voices render the same as single units
+	for (BKInt i = 0; i < 3; i++) {
+		assert(BKContextGenerate(&bankCtxs[0], frames, 300) == 300);
+		assert(BKContextGenerate(&bankCtxs[1], largeFrames, 300) == 300);
+		assert(memcmp(frames, largeFrames, sizeof(frames)) == 0);
+	}
+
+	// voices with the same waveform and period step together
+	assert(bank.time[0] == bank.time[2] && bank.time[4] == bank.time[6]);
+	assert(bank.phase[4] != bank.phase[6]);
+
+	for (BKInt i = 0; i < 8; i++) {
+		BKUnitBankSetVoiceAttr(&bank, i * 2, BK_MUTE, 1);
+	}
+
+	assert(BKContextGenerate(&bankCtxs[1], largeFrames, 300) == 300);
+	assert(bankCtxs[1].firstActiveUnit == NULL);
+
+	BKUnitBankSetVoiceAttr(&bank, 0, BK_MUTE, 0);
+	assert(bankCtxs[1].firstActiveUnit == &bank.unit);
+
+	for (BKInt i = 0; i < 8; i++) {
+		BKDispose(&bankUnits[i]);
+	}
+
+	for (BKInt i = 0; i < 2; i++) {
+		BKDispose(&bankCtxs[i]);
+	}
+
+	BKDispose(&bank);
+
+	// check profiling counters
+
+#if BK_USE_PROFILING
+	BKContextProfile ctxProfile;
+
+	assert(BKGetPtr(&ctxs[0], BK_PROFILE, &ctxProfile, sizeof(ctxProfile)) == 0);
+	assert(ctxProfile.numBlocks > 0 && ctxProfile.numClockTicks > 0);
+	assert(ctxProfile.numReads > 0 && ctxProfile.numReadFrames > 0);
+
+	assert(BKSetAttr(&ctxs[0], BK_PROFILE, 0) == 0);
+	assert(BKGetPtr(&ctxs[0], BK_PROFILE, &ctxProfile, sizeof(ctxProfile)) == 0);
+	assert(ctxProfile.numBlocks == 0 && ctxProfile.numReads == 0);
+#else
+	assert(BKSetAttr(&ctxs[0], BK_PROFILE, 0) == BK_INVALID_ATTRIBUTE);
+#endif
+
+	// check snapshots
+
+	BKContext snapCtx;
+	BKTrack snapTracks[2];
+	BKInstrument snapInstr;
+	BKInt snapVolumes[4] = {BK_MAX_VOLUME, BK_MAX_VOLUME / 2, BK_MAX_VOLUME / 4, BK_MAX_VOLUME / 2};
+	BKInt snapVibrato[2] = {10, BK_FINT20_UNIT};
+	BKInt snapArpeggio[3] = {2, 0, 7 * BK_FINT20_UNIT};
+
+	BKContextInit(&snapCtx, 2, 44100);
+	BKInstrumentInit(&snapInstr);
+	BKInstrumentSetSequence(&snapInstr, BK_SEQUENCE_VOLUME, snapVolumes, 4, 0, 4);
+
+	for (BKInt i = 0; i < 2; i++) {
+		BKTrackInit(&snapTracks[i], i ? BK_NOISE : BK_SQUARE);
+		BKTrackAttach(&snapTracks[i], &snapCtx);
+		BKSetAttr(&snapTracks[i], BK_MASTER_VOLUME, BK_MAX_VOLUME / 4);
+		BKSetAttr(&snapTracks[i], BK_VOLUME, BK_MAX_VOLUME);
+		BKSetAttr(&snapTracks[i], BK_NOTE, (BK_A_4 + i * 5) * BK_FINT20_UNIT);
+	}
+
+	BKSetPtr(&snapTracks[0], BK_INSTRUMENT, &snapInstr, sizeof(void*));
+	BKSetPtr(&snapTracks[0], BK_EFFECT_VIBRATO, snapVibrato, sizeof(snapVibrato));
+	BKSetPtr(&snapTracks[1], BK_ARPEGGIO, snapArpeggio, sizeof(snapArpeggio));
+
+	for (BKInt i = 0; i < 5; i++) {
+		assert(BKContextGenerate(&snapCtx, frames, 277) == 277);
+	}
+
+	BKInt snapSize = BKContextSnapshot(&snapCtx, NULL, 0);
+	char* snapshot = malloc(snapSize + 1);
+
+	assert(snapSize > 0);
+	assert(BKContextSnapshot(&snapCtx, snapshot, snapSize - 1) == BK_INVALID_VALUE);
+	assert(BKContextSnapshot(&snapCtx, snapshot, snapSize) == snapSize);
+	assert(BKContextGenerate(&snapCtx, frames, 300) == 300);
+
+	// changes after the snapshot are undone
+	BKSetAttr(&snapTracks[0], BK_NOTE, BK_C_2 * BK_FINT20_UNIT);
+	BKSetAttr(&snapTracks[1], BK_WAVEFORM, BK_TRIANGLE);
+	BKSetPtr(&snapTracks[0], BK_INSTRUMENT, NULL, sizeof(void*));
+	assert(BKContextGenerate(&snapCtx, largeFrames, 300) == 300);
+
+	// instrument has to be the same
+	assert(BKContextRestore(&snapCtx, snapshot, snapSize) == BK_INVALID_STATE);
+	BKSetPtr(&snapTracks[0], BK_INSTRUMENT, &snapInstr, sizeof(void*));
+
+	// sample is not copied and has to be the same
+	BKData snapSample;
+
+	snapTracks[0].sample = &snapSample;
+	assert(BKContextRestore(&snapCtx, snapshot, snapSize) == BK_INVALID_STATE);
+	assert(snapTracks[0].sample == &snapSample);
+	snapTracks[0].sample = NULL;
+
+	assert(BKContextRestore(&snapCtx, snapshot, snapSize) == 0);
+	assert(BKContextGenerate(&snapCtx, largeFrames, 300) == 300);
+	assert(memcmp(frames, largeFrames, sizeof(frames)) == 0);
+
+	// snapshot is relocatable
+	memmove(&snapshot[1], snapshot, snapSize);
+	assert(BKContextRestore(&snapCtx, &snapshot[1], snapSize) == 0);
+	assert(BKContextGenerate(&snapCtx, largeFrames, 300) == 300);
+	assert(memcmp(frames, largeFrames, sizeof(frames)) == 0);
+
+	assert(BKContextRestore(&snapCtx, &snapshot[1], 16) == BK_INVALID_VALUE);
+	BKTrackDetach(&snapTracks[1]);
+	assert(BKContextRestore(&snapCtx, &snapshot[1], snapSize) == BK_INVALID_STATE);
+
+	free(snapshot);
+
+	for (BKInt i = 0; i < 2; i++) {
+		BKDispose(&snapTracks[i]);
+	}
+
+	BKDispose(&snapInstr);
+	BKDispose(&snapCtx);
+
+	// check skipping
+
+	BKContext skipCtxs[2];
+	BKTrack skipTracks[2][3];
+	BKInstrument skipInstr;
+	BKData skipSample;
+	BKFrame skipFrames[64];
+
+	for (BKInt i = 0; i < 64; i++) {
+		skipFrames[i] = i * 1000 - 32000;
+	}
+
+	BKInstrumentInit(&skipInstr);
+	BKInstrumentSetSequence(&skipInstr, BK_SEQUENCE_VOLUME, snapVolumes, 4, 0, 4);
+	BKDataInit(&skipSample);
+	BKDataSetFrames(&skipSample, skipFrames, 64, 1, 1);
+
+	for (BKInt i = 0; i < 2; i++) {
+		BKContextInit(&skipCtxs[i], 2, 44100);
+
+		for (BKInt j = 0; j < 3; j++) {
+			BKTrackInit(&skipTracks[i][j], BK_SQUARE);
+			BKTrackAttach(&skipTracks[i][j], &skipCtxs[i]);
+			BKSetAttr(&skipTracks[i][j], BK_MASTER_VOLUME, BK_MAX_VOLUME / 4);
+			BKSetAttr(&skipTracks[i][j], BK_VOLUME, BK_MAX_VOLUME);
+		}
+
+		BKSetPtr(&skipTracks[i][0], BK_INSTRUMENT, &skipInstr, sizeof(void*));
+		BKSetPtr(&skipTracks[i][0], BK_EFFECT_VIBRATO, snapVibrato, sizeof(snapVibrato));
+		BKSetAttr(&skipTracks[i][1], BK_WAVEFORM, BK_NOISE);
+		BKSetAttr(&skipTracks[i][1], BK_PHASE_WRAP, 1000);
+		BKSetPtr(&skipTracks[i][1], BK_ARPEGGIO, snapArpeggio, sizeof(snapArpeggio));
+		BKSetPtr(&skipTracks[i][2], BK_SAMPLE, &skipSample, 0);
+		BKSetAttr(&skipTracks[i][2], BK_SAMPLE_REPEAT, BK_PALINDROME);
+		BKSetAttr(&skipTracks[i][2], BK_SAMPLE_PITCH, 7 * BK_FINT20_UNIT);
+
+		for (BKInt j = 0; j < 3; j++) {
+			BKSetAttr(&skipTracks[i][j], BK_NOTE, (BK_A_4 + j * 5) * BK_FINT20_UNIT);
+		}
+	}
+
+	for (BKInt i = 0; i < 20; i++) {
+		assert(BKContextGenerate(&skipCtxs[0], largeBuffer, 1000) == 1000);
+	}
+
+	assert(BKContextSkip(&skipCtxs[1], BKTimeMake(20000, 0)) == 0);
+	assert(BKContextSize(&skipCtxs[1]) == 0);
+
+	// units end at the same clock tick after rendering again
+	for (BKInt i = 0; i < 2; i++) {
+		assert(BKContextGenerate(&skipCtxs[i], largeBuffer, 500) == 500);
+	}
+
+	assert(BKTimeIsEqual(skipCtxs[0].currentTime, skipCtxs[1].currentTime));
+
+	for (BKInt j = 0; j < 3; j++) {
+		BKUnit const* unit = &skipTracks[0][j].unit;
+		BKUnit const* skipUnit = &skipTracks[1][j].unit;
+
+		assert(unit->time == skipUnit->time);
+		assert(unit->period == skipUnit->period);
+		assert(unit->volume[0] == skipUnit->volume[0]);
+		assert(unit->phase.phase == skipUnit->phase.phase);
+		assert(unit->phase.wrapCount == skipUnit->phase.wrapCount);
+		assert(unit->sample.timeFrac == skipUnit->sample.timeFrac);
+		assert(unit->sample.period == skipUnit->sample.period);
+	}
+
+	BKInt nonzero = 0;
+
+	for (BKInt i = 0; i < 2 * 500; i++) {
+		nonzero |= largeBuffer[i];
+	}
+
+	assert(nonzero != 0);
+
+	for (BKInt i = 0; i < 2; i++) {
+		for (BKInt j = 0; j < 3; j++) {
+			BKDispose(&skipTracks[i][j]);
+		}
+
+		BKDispose(&skipCtxs[i]);
+	}
+
+	BKDispose(&skipInstr);
+	BKDispose(&skipSample);
+
+	// check pulse kernels
+
+	BKBufferPulse pulse;
+
+	assert(BKBufferPulseInit(&pulse, BK_PULSE_KERNEL_HARM, 8, 1.0) == 0);
+	assert(BKSetPtr(&ctxs[0], BK_PULSE_KERNEL, &pulse, 0) == 0);
+	assert(BKContextGenerate(&ctxs[0], frames, 300) == 300);
+
+	pulse.width = 0;
+	assert(BKSetPtr(&ctxs[0], BK_PULSE_KERNEL, &pulse, 0) == BK_INVALID_VALUE);
+
+	for (BKInt i = 0; i < 3; i++) {
+		BKDispose(&tracks[i]);
+		BKDispose(&ctxs[i]);
+	}
+
 	return 0;
 }
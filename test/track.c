@@ -1,5 +1,35 @@
 #include "test.h"
 
+/**
+ * Render pitched sample and return energy of frames after the kernel delay
+ */
+static double renderSample(BKData* data, BKEnum interpolation, BKEnum repeat, BKInt phase, BKFrame outFrames[1000]) {
+	BKContext ctx;
+	BKUnit unit;
+	double energy = 0.0;
+
+	BKContextInit(&ctx, 1, 44100);
+	BKUnitInit(&unit, BK_SQUARE);
+	BKUnitAttach(&unit, &ctx);
+	BKSetPtr(&unit, BK_SAMPLE, data, 0);
+	BKSetAttr(&unit, BK_PERIOD, BK_FINT20_UNIT);
+	BKSetAttr(&unit, BK_SAMPLE_PERIOD, BK_FINT20_UNIT * 17 / 10);
+	BKSetAttr(&unit, BK_SAMPLE_INTERPOLATION, interpolation);
+	BKSetAttr(&unit, BK_SAMPLE_REPEAT, repeat);
+	BKSetAttr(&unit, BK_PHASE, phase);
+	BKSetAttr(&unit, BK_VOLUME, BK_MAX_VOLUME / 2);
+	assert(BKContextGenerate(&ctx, outFrames, 1000) == 1000);
+
+	for (BKInt i = 100; i < 1000; i++) {
+		energy += (double)outFrames[i] * outFrames[i];
+	}
+
+	BKDispose(&unit);
+	BKDispose(&ctx);
+
+	return energy;
+}
+
 int main(int argc, char const* argv[]) {
 	BKInt res;
 	BKTrack* track = INVALID_PTR;
@@ -31,11 +61,171 @@ int main(int argc, char const* argv[]) {
 
 	assert(res == 0);
 
+	// check sample interpolation
+
+	BKInt interpolation = -1;
+
+	assert(BKSetAttr(track, BK_SAMPLE_INTERPOLATION, 99) == BK_INVALID_VALUE);
+	assert(BKSetAttr(track, BK_SAMPLE_INTERPOLATION, BK_INTERPOLATION_CUBIC) == 0);
+	assert(BKGetAttr(track, BK_SAMPLE_INTERPOLATION, &interpolation) == 0);
+	assert(interpolation == BK_INTERPOLATION_CUBIC);
+
+	// sinc kernel filters frequencies above output Nyquist frequency when pitched up
+
+	BKData sample;
+	BKFrame sampleFrames[4096];
+	BKFrame sampleOut[2][1000];
+
+	for (BKInt i = 0; i < 4096; i++) {
+		sampleFrames[i] = i & 1 ? 8000 : -8000;
+	}
+
+	BKDataInit(&sample);
+	BKDataSetFrames(&sample, sampleFrames, 4096, 1, 1);
+
+	double linearEnergy = renderSample(&sample, BK_INTERPOLATION_LINEAR, BK_NO_REPEAT, 0, sampleOut[0]);
+	double sincEnergy = renderSample(&sample, BK_INTERPOLATION_SINC, BK_NO_REPEAT, 0, sampleOut[1]);
+
+	assert(sincEnergy < linearEnergy / 100);
+
+	// kernel taps wrap around repeated sample
+
+	for (BKInt i = 0; i < 512; i++) {
+		sampleFrames[i] = ((i * 37) & 63) * 500 - 16000;
+	}
+
+	BKDataSetFrames(&sample, sampleFrames, 64, 1, 1);
+	renderSample(&sample, BK_INTERPOLATION_SINC, BK_REPEAT, 0, sampleOut[0]);
+
+	// same as the following sample periods
+	BKDataSetFrames(&sample, sampleFrames, 512, 1, 1);
+	renderSample(&sample, BK_INTERPOLATION_SINC, BK_NO_REPEAT, 64, sampleOut[1]);
+
+	assert(memcmp(sampleOut[0], sampleOut[1], 200 * sizeof(BKFrame)) == 0);
+
+	BKDispose(&sample);
+
+	// check wavetable
+
+	BKData* table;
+	BKFrame tableFrames[1000];
+	BKFrame frames[2 * 300];
+	BKInt numPhases = 0, waveform = 0, nonzero = 0;
+
+	for (BKInt i = 0; i < 1000; i++) {
+		tableFrames[i] = (i * 64) - 32000;
+	}
+
+	assert(BKDataAlloc(&table) == 0);
+	assert(BKDataSetFrames(table, tableFrames, 1000, 1, 1) == 0);
+	assert(BKSetPtr(track, BK_WAVETABLE, table, 0) == 0);
+	assert(BKGetAttr(track, BK_WAVEFORM, &waveform) == 0);
+	assert(waveform == BK_WAVETABLE);
+	assert(BKGetAttr(track, BK_NUM_PHASES, &numPhases) == 0);
+	assert(numPhases == 1024);
+
+	BKSetAttr(track, BK_MASTER_VOLUME, BK_MAX_VOLUME / 4);
+	BKSetAttr(track, BK_VOLUME, BK_MAX_VOLUME);
+	BKSetAttr(track, BK_NOTE, BK_C_7 * BK_FINT20_UNIT);
+	assert(BKContextGenerate(ctx, frames, 300) == 300);
+
+	for (BKInt i = 0; i < 2 * 300; i++) {
+		nonzero |= frames[i];
+	}
+
+	assert(nonzero != 0);
+
+	BKDispose(table);
+	assert(track->unit.waveform == 0);
+
 	BKTrackDetach(track);
 
 	assert(track->unit.ctx == NULL);
 
 	BKDispose(track);
+
+	// check voice pool
+
+	BKVoicePool* pool = INVALID_PTR;
+	BKInstrument* instr = INVALID_PTR;
+	BKInt volumeSequence[] = {BK_MAX_VOLUME, BK_MAX_VOLUME / 2, BK_MAX_VOLUME / 4, 0};
+	BKInt voices[5];
+
+	assert(BKVoicePoolAlloc(&pool, 0, BK_SQUARE) == BK_INVALID_VALUE);
+	assert(pool == NULL);
+	assert(BKVoicePoolAlloc(&pool, 2, BK_SQUARE) == 0);
+	assert(BKVoicePoolAttach(pool, ctx) == 0);
+	assert(BKVoicePoolAttach(pool, ctx) == BK_INVALID_STATE);
+
+	assert(BKInstrumentAlloc(&instr) == 0);
+	assert(BKInstrumentSetSequence(instr, BK_SEQUENCE_VOLUME, volumeSequence, 4, 0, 1) == 0);
+	assert(BKSetPtr(pool, BK_INSTRUMENT, instr, 0) == 0);
+	assert(BKSetAttr(pool, BK_MASTER_VOLUME, BK_MAX_VOLUME / 4) == 0);
+	assert(BKSetAttr(pool, BK_VOLUME, BK_MAX_VOLUME) == 0);
+	assert(BKSetAttr(pool, BK_NOTE, BK_A_4 * BK_FINT20_UNIT) == BK_INVALID_ATTRIBUTE);
+
+	// unused voices sleep
+	assert(BKContextGenerate(ctx, frames, 300) == 300);
+	assert(ctx->firstActiveUnit == NULL);
+
+	assert(BKVoicePoolNoteOn(pool, BK_NOTE_RELEASE) == BK_INVALID_VALUE);
+
+	voices[0] = BKVoicePoolNoteOn(pool, BK_A_4 * BK_FINT20_UNIT);
+	voices[1] = BKVoicePoolNoteOn(pool, BK_C_5 * BK_FINT20_UNIT);
+
+	assert(voices[0] >= 0 && voices[1] >= 0 && voices[0] != voices[1]);
+	assert(BKVoicePoolGetTrack(pool, voices[0]) == &pool->tracks[0]);
+	assert(BKVoicePoolGetTrack(pool, voices[1]) == &pool->tracks[1]);
+	assert(BKContextGenerate(ctx, frames, 300) == 300);
+	assert(ctx->firstActiveUnit != NULL);
+
+	// released voice is stolen before held voice
+	assert(BKVoicePoolNoteOff(pool, voices[1]) == 0);
+
+	voices[2] = BKVoicePoolNoteOn(pool, BK_E_5 * BK_FINT20_UNIT);
+
+	assert(BKVoicePoolGetTrack(pool, voices[2]) == &pool->tracks[1]);
+	assert(BKVoicePoolGetTrack(pool, voices[1]) == NULL);
+	assert(BKVoicePoolNoteOff(pool, voices[1]) == BK_INVALID_STATE);
+	assert(BKVoicePoolGetTrack(pool, voices[0]) != NULL);
+
+	// oldest voice is stolen if voices are equally loud
+	assert(BKContextGenerate(ctx, frames, 300) == 300);
+
+	voices[3] = BKVoicePoolNoteOn(pool, BK_G_5 * BK_FINT20_UNIT);
+
+	assert(BKVoicePoolGetTrack(pool, voices[3]) == &pool->tracks[0]);
+	assert(BKVoicePoolGetTrack(pool, voices[0]) == NULL);
+	assert(BKVoicePoolGetTrack(pool, voices[2]) != NULL);
+
+	// ended voices sleep and are reused
+	assert(BKVoicePoolNoteOff(pool, voices[2]) == 0);
+	assert(BKVoicePoolNoteOff(pool, voices[3]) == 0);
+
+	for (BKInt i = 0; i < 100; i++) {
+		assert(BKContextGenerate(ctx, frames, 300) == 300);
+	}
+
+	assert(ctx->firstActiveUnit == NULL);
+
+	voices[4] = BKVoicePoolNoteOn(pool, BK_A_4 * BK_FINT20_UNIT);
+
+	assert(BKVoicePoolGetTrack(pool, voices[4]) == &pool->tracks[0]);
+	assert(BKVoicePoolGetTrack(pool, voices[2]) == NULL);
+	assert(BKVoicePoolGetTrack(pool, voices[3]) == NULL);
+
+	// voices started since the last run are stolen after louder voices
+	assert(BKContextGenerate(ctx, frames, 300) == 300);
+
+	voices[0] = BKVoicePoolNoteOn(pool, BK_C_5 * BK_FINT20_UNIT);
+	voices[1] = BKVoicePoolNoteOn(pool, BK_E_5 * BK_FINT20_UNIT);
+
+	assert(BKVoicePoolGetTrack(pool, voices[0]) == &pool->tracks[1]);
+	assert(BKVoicePoolGetTrack(pool, voices[1]) == &pool->tracks[0]);
+	assert(BKVoicePoolGetTrack(pool, voices[4]) == NULL);
+
+	BKDispose(pool);
+	BKDispose(instr);
 	BKDispose(ctx);
 
 	return 0;
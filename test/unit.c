@@ -0,0 +1,50 @@
+#include "test.h"
+
+int main(int argc, char const* argv[]) {
+	BKContext ctx;
+	BKUnit unit;
+	BKData data;
+	BKData* dataRef = NULL;
+	BKFrame dataFrames[16] = {0, 16000, -16000, 0};
+	BKFrame frames[2 * 300];
+
+	BKContextInit(&ctx, 2, 44100);
+	BKUnitInit(&unit, BK_SQUARE);
+	BKUnitAttach(&unit, &ctx);
+	BKDataInit(&data);
+	BKDataSetFrames(&data, dataFrames, 16, 1, 1);
+
+	// check pointer attributes
+
+	assert(BKSetPtr(&unit, BK_SAMPLE, &data, 0) == 0);
+	BKSetAttr(&unit, BK_PERIOD, BK_FINT20_UNIT);
+	BKSetAttr(&unit, BK_SAMPLE_REPEAT, BK_REPEAT);
+	BKSetAttr(&unit, BK_VOLUME, BK_MAX_VOLUME / 2);
+	assert(BKContextGenerate(&ctx, frames, 300) == 300);
+
+	assert(BKGetPtr(&unit, BK_SAMPLE, &dataRef, sizeof(dataRef)) == 0);
+	assert(dataRef == &data);
+	assert(unit.sample.dataState.data == &data);
+
+	// check profiling counters
+
+#if BK_USE_PROFILING
+	BKUnitProfile profile;
+
+	assert(BKGetPtr(&unit, BK_PROFILE, &profile, sizeof(profile)) == 0);
+	assert(profile.numRuns > 0 && profile.numPulses > 0 && profile.numFrames > 0);
+
+	assert(BKSetAttr(&unit, BK_PROFILE, 0) == 0);
+	assert(BKGetPtr(&unit, BK_PROFILE, &profile, sizeof(profile)) == 0);
+	assert(profile.numRuns == 0 && profile.numPulses == 0);
+#else
+	assert(BKGetPtr(&unit, BK_PROFILE, &dataRef, sizeof(dataRef)) == BK_INVALID_ATTRIBUTE);
+	assert(BKSetAttr(&unit, BK_PROFILE, 0) == BK_INVALID_ATTRIBUTE);
+#endif
+
+	BKDispose(&unit);
+	BKDispose(&data);
+	BKDispose(&ctx);
+
+	return 0;
+}